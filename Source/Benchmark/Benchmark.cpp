@@ -0,0 +1,525 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+// Benchmark for the converter.  Synthetic drill files are generated for every
+// dialect profile and size, and each phase is timed:
+//
+// - read:  splitting the input into lines
+// - parse: converting the input, already in memory, into a recording of the
+//          plotter operations
+// - emit:  formatting the recording of the parse into an output file
+// - pipe:  converting into an output file, with reading, parsing and
+//          writing pipelined over three threads
+//
+// Results can be saved as a baseline, and later runs compared against it.
+//
+// The routing profile is also checked for closed outlines (its rectangles)
+// surviving exact simplification with every corner, and the file given to
+// --check (Statistics.drl) for the counters of every tool and code.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+    #include <sys/resource.h>
+#endif
+
+#include "Generator.h"
+#include "../Converter.h"
+#include "../Gerber.h"
+#include "../Record.h"
+#include "../Simplify.h"
+//------------------------------------------------------------------------------
+
+struct RESULT{
+    std::string Profile;
+    long long   Hits;
+    std::string Phase;
+    double      Time;    // Wall clock, in seconds
+    double      CPU;     // Process CPU time, in seconds
+    double      MBps;    // Input MB per second
+    double      HitsPs;  // Holes and segments per second
+    double      PeakMB;  // Peak resident set size during the phase
+};
+//------------------------------------------------------------------------------
+
+static double Now(){
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+//------------------------------------------------------------------------------
+
+// Resets the peak resident set size, where the OS supports it
+static void ResetPeak(){
+    #ifdef __linux__
+        FILE* File = fopen("/proc/self/clear_refs", "w");
+        if(File){
+            fputs("5", File);
+            fclose(File);
+        }
+    #endif
+}
+//------------------------------------------------------------------------------
+
+// Peak resident set size, in MB
+static double PeakMB(){
+    #ifdef __linux__
+        FILE* File = fopen("/proc/self/status", "r");
+        if(File){
+            char Line[0x100];
+            while(fgets(Line, sizeof(Line), File)){
+                if(!strncmp(Line, "VmHWM:", 6)){
+                    fclose(File);
+                    return atof(Line+6) / 1024.0;
+                }
+            }
+            fclose(File);
+        }
+    #endif
+    #ifndef _WIN32
+        struct rusage Usage;
+        getrusage(RUSAGE_SELF, &Usage);
+        #ifdef __APPLE__
+            return Usage.ru_maxrss / 1048576.0;
+        #else
+            return Usage.ru_maxrss / 1024.0;
+        #endif
+    #else
+        return 0;
+    #endif
+}
+//------------------------------------------------------------------------------
+
+static size_t FileSize(const char* Filename){
+    FILE* File = fopen(Filename, "rb");
+    if(!File) return 0;
+    fseek(File, 0, SEEK_END);
+    size_t Size = ftell(File);
+    fclose(File);
+    return Size;
+}
+//------------------------------------------------------------------------------
+
+// The input in memory and the recording of its last parse, so that parsing
+// excludes reading the file and emitting excludes parsing
+struct PHASE_STATE{
+    std::string Data;
+    RECORDER    Recorded;
+
+    bool Load(const char* Filename){
+        FILE* File = fopen(Filename, "rb");
+        if(!File) return false;
+        Data.resize(FileSize(Filename));
+        size_t Count = fread(&Data[0], 1, Data.size(), File);
+        fclose(File);
+        Recorded.Clear();
+        return Count == Data.size();
+    }
+};
+//------------------------------------------------------------------------------
+
+// Phases are repeated until they took at least MinimumTime, and the fastest
+// repetition is reported
+static const double MinimumTime    = 0.2;
+static const int    MaxRepetitions = 10;
+//------------------------------------------------------------------------------
+
+enum PHASE{ Phase_Read, Phase_Parse, Phase_Emit, Phase_Pipe };
+static const char* PhaseNames[] = {"read", "parse", "emit", "pipe"};
+//------------------------------------------------------------------------------
+
+static bool RunPhase(
+    PHASE        Phase,
+    const char*  Input,
+    const char*  Output,
+    PHASE_STATE& State
+){
+    READER Reader;
+
+    switch(Phase){
+        case Phase_Read:{
+            if(!Reader.Open(Input)) return false;
+            LINE   Line;
+            size_t Count = 0;
+            while(Reader.ReadLine(Line)) Count += Line.Length;
+            return Count > 0;
+        }
+
+        case Phase_Parse:{
+            Reader.Open(State.Data.data(), State.Data.size());
+            State.Recorded.Clear();
+            CONVERTER Converter;
+            Converter.Convert(&Reader, &State.Recorded);
+            return State.Recorded.Length() > 0;
+        }
+
+        case Phase_Emit:{
+            if(!State.Recorded.Length()) return false;
+            FILE* File = fopen(Output, "wb");
+            if(!File) return false;
+            FILE_SINK     Sink(File);
+            GERBER_WRITER Gerber;
+            Gerber.Open(&Sink);
+            Replay(State.Recorded.Data(), State.Recorded.Length(), &Gerber);
+            bool Result = Gerber.Flush();
+            fclose(File);
+            return Result;
+        }
+
+        case Phase_Pipe:{
+            if(!Reader.Open(Input)) return false;
+            FILE* File = fopen(Output, "wb");
+            if(!File) return false;
+            FILE_SINK Sink(File);
+            CONVERTER Converter;
+            bool Result = Converter.ConvertPipelined(&Reader, &Sink);
+            fclose(File);
+            return Result;
+        }
+    }
+    return false;
+}
+//------------------------------------------------------------------------------
+
+// The generated rectangles are closed runs without redundant vertices, so
+// exact simplification must keep every segment
+static bool CheckSimplify(const char* Input){
+    READER Reader;
+    if(!Reader.Open(Input)) return false;
+
+    NULL_SINK     Sink;
+    GERBER_WRITER Gerber;
+    Gerber.Open(&Sink);
+
+    SIMPLIFY  Simplify(&Gerber);
+    CONVERTER Converter;
+    if(!Converter.Convert(&Reader, &Simplify)) return false;
+
+    return Simplify.SegmentsIn > 0 && Simplify.SegmentsOut == Simplify.SegmentsIn;
+}
+//------------------------------------------------------------------------------
+
+static bool CheckTool(
+    const STATISTICS& Statistics,
+    int               Number,
+    long long         Hits,
+    long long         Slots,
+    long long         Routes,
+    long long         Arcs,
+    long long         Repeats
+){
+    auto Found = Statistics.Tools.find(Number);
+    if(Found == Statistics.Tools.end()) return false;
+
+    const TOOL_COUNTS& Counts = Found->second;
+    return Counts.Hits   == Hits   && Counts.Slots == Slots && Counts.Repeats == Repeats &&
+           Counts.Routes == Routes && Counts.Arcs  == Arcs;
+}
+//------------------------------------------------------------------------------
+
+// The expected counters of Statistics.drl, which has a line for each of them
+static bool CheckStatistics(const char* Input){
+    READER Reader;
+    if(!Reader.Open(Input)) return false;
+
+    NULL_SINK Sink;
+    CONVERTER Converter;
+    if(!Converter.Convert(&Reader, &Sink)) return false;
+
+    const STATISTICS& Statistics = Converter.Statistics;
+    if(Statistics.Tools.size() != 2) return false;
+
+    if(!CheckTool(Statistics, 1, 5, 1, 1, 0, 1) ||
+       !CheckTool(Statistics, 2, 0, 0, 2, 1, 0)) return false;
+
+    const std::map<std::string, long long> Unsupported = {{"G07", 1}};
+    const std::map<std::string, long long> Ignored = {
+        {"FMAT", 1}, {"G90", 1}, {"G93", 1}, {"ICI", 1},
+        {"M09" , 1}, {"M47", 1}, {"M71", 1}, {"VER", 1}
+    };
+    return Statistics.Unsupported == Unsupported && Statistics.Ignored == Ignored;
+}
+//------------------------------------------------------------------------------
+
+static bool Measure(
+    PHASE        Phase,
+    const char*  Input,
+    const char*  Output,
+    PHASE_STATE& State,
+    size_t       Bytes,
+    long long    Hits,
+    RESULT&      Result
+){
+    Result.Time = 1e300;
+    Result.CPU  = 1e300;
+
+    ResetPeak();
+
+    double Total = 0;
+    for(int n = 0; n < MaxRepetitions && Total < MinimumTime; n++){
+        double  Start    = Now();
+        clock_t CPUStart = clock();
+
+        if(!RunPhase(Phase, Input, Output, State)) return false;
+
+        double Time = Now() - Start;
+        double CPU  = (double)(clock() - CPUStart) / CLOCKS_PER_SEC;
+
+        if(Result.Time > Time) Result.Time = Time;
+        if(Result.CPU  > CPU ) Result.CPU  = CPU;
+        Total += Time;
+    }
+    if(Result.Time <= 0) Result.Time = 1e-9;
+
+    Result.Phase  = PhaseNames[Phase];
+    Result.MBps   = Bytes / 1e6 / Result.Time;
+    Result.HitsPs = Hits / Result.Time;
+    Result.PeakMB = PeakMB();
+    return true;
+}
+//------------------------------------------------------------------------------
+
+static void Print(FILE* File, const RESULT& Result){
+    fprintf(File,
+        "%-8s %10lld %-5s %10.4f %10.4f %10.1f %12.0f %9.1f\n",
+        Result.Profile.c_str(), Result.Hits, Result.Phase.c_str(),
+        Result.Time, Result.CPU, Result.MBps, Result.HitsPs, Result.PeakMB
+    );
+}
+//------------------------------------------------------------------------------
+
+static const char* TableHeader =
+    "# profile      hits phase       wall        cpu       MB/s       hits/s   peak MB\n";
+//------------------------------------------------------------------------------
+
+static bool Load(const char* Filename, std::vector<RESULT>& Results){
+    FILE* File = fopen(Filename, "r");
+    if(!File) return false;
+
+    char Line[0x400];
+    while(fgets(Line, sizeof(Line), File)){
+        if(Line[0] == '#') continue;
+
+        char   Profile[0x40], Phase[0x40];
+        RESULT Result;
+        if(sscanf(Line, "%63s %lld %63s %lf %lf %lf %lf %lf",
+            Profile, &Result.Hits, Phase, &Result.Time, &Result.CPU,
+            &Result.MBps, &Result.HitsPs, &Result.PeakMB
+        ) == 8){
+            Result.Profile = Profile;
+            Result.Phase   = Phase;
+            Results.push_back(Result);
+        }
+    }
+    fclose(File);
+    return true;
+}
+//------------------------------------------------------------------------------
+
+static long long ParseCount(const char* String){
+    char*     End;
+    long long Count = strtoll(String, &End, 10);
+    switch(*End){
+        case 'k': case 'K': Count *= 1000;       break;
+        case 'm': case 'M': Count *= 1000000;    break;
+        case 'g': case 'G': Count *= 1000000000; break;
+        default: break;
+    }
+    return Count;
+}
+//------------------------------------------------------------------------------
+
+static void Usage(){
+    printf(
+        "Usage: Benchmark [options]\n"
+        "       Benchmark --generate profile hits output_file\n"
+        "\n"
+        "Options:\n"
+        "  --min hits         Smallest file size (default 1K)\n"
+        "  --max hits         Largest file size (default 1M, up to 100M)\n"
+        "  --profile name     Only run the given profile\n"
+        "  --work directory   Where the temporary files are written\n"
+        "  --save file        Save the results as a baseline\n"
+        "  --compare file     Compare the results against a baseline\n"
+        "  --tolerance %%      Allowed slow-down before flagging a regression\n"
+        "                     (default 20)\n"
+        "  --check file       Check the statistics of the given test file first\n"
+        "\n"
+        "Profiles:"
+    );
+    for(int n = 0; n < GENERATOR::Profile_Count; n++){
+        printf(" %s", GENERATOR::Name((GENERATOR::PROFILE)n));
+    }
+    printf("\n");
+}
+//------------------------------------------------------------------------------
+
+int main(int argc, char** argv){
+    long long   Min       = 1000;
+    long long   Max       = 1000000;
+    const char* Profile   = 0;
+    std::string Work      = ".";
+    const char* Save      = 0;
+    const char* Compare   = 0;
+    double      Tolerance = 20;
+    const char* Check     = 0;
+
+    for(int n = 1; n < argc; n++){
+        if(!strcmp(argv[n], "--generate") && n+3 < argc){
+            GENERATOR::PROFILE Profile;
+            if(!GENERATOR::Find(argv[n+1], &Profile)){
+                printf("Unknown profile \"%s\"\n", argv[n+1]);
+                return 1;
+            }
+            FILE* File = fopen(argv[n+3], "wb");
+            if(!File){
+                printf("Cannot open \"%s\" for writing\n", argv[n+3]);
+                return 1;
+            }
+            FILE_SINK Sink(File);
+            GENERATOR Generator;
+            bool Result = Generator.Generate(Profile, ParseCount(argv[n+2]), &Sink);
+            fclose(File);
+            return Result ? 0 : 1;
+
+        }else if(!strcmp(argv[n], "--min"      ) && n+1 < argc){ Min       = ParseCount(argv[++n]);
+        }else if(!strcmp(argv[n], "--max"      ) && n+1 < argc){ Max       = ParseCount(argv[++n]);
+        }else if(!strcmp(argv[n], "--profile"  ) && n+1 < argc){ Profile   = argv[++n];
+        }else if(!strcmp(argv[n], "--work"     ) && n+1 < argc){ Work      = argv[++n];
+        }else if(!strcmp(argv[n], "--save"     ) && n+1 < argc){ Save      = argv[++n];
+        }else if(!strcmp(argv[n], "--compare"  ) && n+1 < argc){ Compare   = argv[++n];
+        }else if(!strcmp(argv[n], "--tolerance") && n+1 < argc){ Tolerance = atof(argv[++n]);
+        }else if(!strcmp(argv[n], "--check"    ) && n+1 < argc){ Check     = argv[++n];
+        }else{
+            Usage();
+            return 1;
+        }
+    }
+
+    if(Check && !CheckStatistics(Check)){
+        printf("The statistics of \"%s\" are not as expected\n", Check);
+        return 1;
+    }
+
+    std::vector<RESULT> Baseline;
+    if(Compare && !Load(Compare, Baseline)){
+        printf("Cannot open \"%s\" for reading\n", Compare);
+        return 1;
+    }
+
+    std::string Input  = Work + "/Benchmark.drl";
+    std::string Output = Work + "/Benchmark.drl.grb";
+
+    std::vector<RESULT> Results;
+    int Regressions = 0;
+
+    printf("%s", TableHeader);
+
+    for(int p = 0; p < GENERATOR::Profile_Count; p++){
+        const char* Name = GENERATOR::Name((GENERATOR::PROFILE)p);
+        if(Profile && strcmp(Profile, Name)) continue;
+
+        for(long long Hits = Min; Hits <= Max; Hits *= 10){
+            FILE* File = fopen(Input.c_str(), "wb");
+            if(!File){
+                printf("Cannot open \"%s\" for writing\n", Input.c_str());
+                return 1;
+            }
+            FILE_SINK Sink(File);
+            GENERATOR Generator;
+            bool Generated = Generator.Generate((GENERATOR::PROFILE)p, Hits, &Sink);
+            fclose(File);
+            if(!Generated){
+                printf("Cannot write \"%s\"\n", Input.c_str());
+                return 1;
+            }
+            size_t Bytes = FileSize(Input.c_str());
+
+            PHASE_STATE State;
+            if(!State.Load(Input.c_str())){
+                printf("Cannot read \"%s\"\n", Input.c_str());
+                return 1;
+            }
+
+            if(p == GENERATOR::Profile_Route && !CheckSimplify(Input.c_str())){
+                printf("Simplifying changed the closed outlines of %s, %lld hits\n",
+                       Name, Hits);
+                return 1;
+            }
+
+            for(int Phase = Phase_Read; Phase <= Phase_Pipe; Phase++){
+                RESULT Result;
+                Result.Profile = Name;
+                Result.Hits    = Hits;
+
+                if(!Measure((PHASE)Phase, Input.c_str(), Output.c_str(), State,
+                            Bytes, Generator.Hits, Result)){
+                    printf("Phase \"%s\" failed for %s, %lld hits\n",
+                           PhaseNames[Phase], Name, Hits);
+                    return 1;
+                }
+                Print(stdout, Result);
+                fflush(stdout);
+                Results.push_back(Result);
+
+                // Very short runs are too noisy to compare
+                for(size_t n = 0; n < Baseline.size(); n++){
+                    const RESULT& Base = Baseline[n];
+                    if(Base.Profile != Result.Profile || Base.Hits  != Result.Hits ||
+                       Base.Phase   != Result.Phase   || Base.Time  <  0.02) continue;
+
+                    double Change = 100.0 * (Result.HitsPs / Base.HitsPs - 1.0);
+                    if(Change < -Tolerance){
+                        printf("  REGRESSION: %.1f%% slower than the baseline\n", -Change);
+                        Regressions++;
+                    }
+                }
+            }
+        }
+    }
+    remove(Input .c_str());
+    remove(Output.c_str());
+
+    if(Save){
+        FILE* File = fopen(Save, "w");
+        if(!File){
+            printf("Cannot open \"%s\" for writing\n", Save);
+            return 1;
+        }
+        fprintf(File, "%s", TableHeader);
+        for(size_t n = 0; n < Results.size(); n++) Print(File, Results[n]);
+        fclose(File);
+    }
+
+    if(Regressions){
+        printf("\n%d regressions against the baseline\n", Regressions);
+        return 2;
+    }
+    return 0;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,301 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Generator.h"
+
+#include <stdlib.h>
+//------------------------------------------------------------------------------
+
+static const char* ProfileNames[GENERATOR::Profile_Count] = {
+    "kicad", "altium", "metric", "route", "holesize"
+};
+//------------------------------------------------------------------------------
+
+const char* GENERATOR::Name(PROFILE Profile){
+    return ProfileNames[Profile];
+}
+//------------------------------------------------------------------------------
+
+bool GENERATOR::Find(const char* Name, PROFILE* Profile){
+    for(int n = 0; n < Profile_Count; n++){
+        if(!strcmp(Name, ProfileNames[n])){
+            *Profile = (PROFILE)n;
+            return true;
+        }
+    }
+    return false;
+}
+//------------------------------------------------------------------------------
+
+GENERATOR::GENERATOR(){
+    State = 1;
+    Hits  = 0;
+
+    Profile        = Profile_Metric;
+    IntDigits      = 3;
+    FractionDigits = 3;
+    LeadingZeros   = false;
+    Decimal        = false;
+    Tools          = 8;
+}
+//------------------------------------------------------------------------------
+
+// xorshift64*
+unsigned GENERATOR::Random(){
+    State ^= State >> 12;
+    State ^= State << 25;
+    State ^= State >> 27;
+    return (State * 0x2545F4914F6CDD1DULL) >> 32;
+}
+//------------------------------------------------------------------------------
+
+// Random coordinate on a 400 mm / 16 inch board centred on the origin
+int GENERATOR::RandomCoord(){
+    int Range = IntDigits == 2 ? 8 : 200;
+    for(int n = 0; n < FractionDigits; n++) Range *= 10;
+    return (int)(Random() % (2*Range)) - Range;
+}
+//------------------------------------------------------------------------------
+
+// Writes Value / 10^Fraction with an explicit decimal point
+void GENERATOR::Fixed(int Value, int Fraction){
+    if(Value < 0){
+        Writer.Char('-');
+        Value = -Value;
+    }
+    int Scale = 1;
+    for(int n = 0; n < Fraction; n++) Scale *= 10;
+    Writer.Int(Value / Scale);
+    Writer.Char('.');
+
+    char Digits[16];
+    Value %= Scale;
+    for(int n = Fraction-1; n >= 0; n--){
+        Digits[n] = '0' + Value % 10;
+        Value /= 10;
+    }
+    Writer.String(Digits, Fraction);
+}
+//------------------------------------------------------------------------------
+
+void GENERATOR::Coordinate(char Axis, int Value){
+    Writer.Char(Axis);
+
+    if(Decimal){
+        Fixed(Value, FractionDigits);
+
+    }else if(LeadingZeros){
+        if(Value < 0){
+            Writer.Char('-');
+            Value = -Value;
+        }else if(Profile == Profile_Holesize){
+            Writer.Char('+');
+        }
+        char Digits[16];
+        int  Count = IntDigits + FractionDigits;
+        for(int n = Count-1; n >= 0; n--){
+            Digits[n] = '0' + Value % 10;
+            Value /= 10;
+        }
+        Writer.String(Digits, Count);
+
+    }else{
+        Writer.Int(Value);
+    }
+}
+//------------------------------------------------------------------------------
+
+void GENERATOR::Point(int X, int Y){
+    Coordinate('X', X);
+    Coordinate('Y', Y);
+}
+//------------------------------------------------------------------------------
+
+void GENERATOR::Header(){
+    switch(Profile){
+        case Profile_KiCad:
+            Writer.String(
+                "M48\n"
+                ";DRILL file {KiCad 5.1.5} date 01/01/2022 12:00:00\n"
+                ";FORMAT={-:-/ absolute / inch / decimal}\n"
+                "FMAT,2\n"
+                "INCH,TZ\n"
+            );
+            for(int n = 1; n <= Tools; n++){
+                Writer.Char('T'); Writer.Int(n);
+                Writer.Char('C'); Fixed(100 + 40*n, 4); Writer.Char('\n');
+            }
+            Writer.String("%\nG90\nG05\n");
+            break;
+
+        case Profile_Altium:
+            Writer.String(";FILE_FORMAT=2:5\nM48\nINCH,LZ,00.00000\n;TYPE=PLATED\n");
+            for(int n = 1; n <= Tools; n++){
+                Writer.Char('T'); Writer.Int(n);
+                Writer.String("F00S00C"); Fixed(1000 + 400*n, 5); Writer.Char('\n');
+            }
+            Writer.String("%\n");
+            break;
+
+        case Profile_Metric:
+        case Profile_Route:
+            Writer.String("M48\nMETRIC,TZ,000.000\n");
+            for(int n = 1; n <= Tools; n++){
+                Writer.String("T0"); Writer.Int(n);
+                Writer.Char('C'); Fixed(200 + 100*n, 3); Writer.Char('\n');
+            }
+            Writer.String("%\nG05\n");
+            break;
+
+        case Profile_Holesize:
+            Writer.String("M48\n");
+            for(int n = 1; n <= Tools; n++){
+                Writer.String("; Holesize "); Writer.Int(n);
+                Writer.String(". = "); Writer.Int(10 + 5*n);
+                Writer.String(".000000 Tolerance = +0.000000/-0.000000 PLATED MILS Quantity = 1\n");
+            }
+            Writer.String("%\n");
+            break;
+
+        default:
+            break;
+    }
+}
+//------------------------------------------------------------------------------
+
+void GENERATOR::Block(int Tool, long long Count){
+    if(Profile == Profile_Holesize){
+        if(Tool == 1) Writer.String("T1\n");
+        else          Writer.String("M00\n");
+    }else{
+        Writer.Char('T');
+        if(Profile != Profile_KiCad && Tool < 10) Writer.Char('0');
+        Writer.Int(Tool);
+        Writer.Char('\n');
+    }
+
+    long long n = 0;
+    while(n < Count){
+        int X = RandomCoord();
+        int Y = RandomCoord();
+
+        switch(Profile){
+            case Profile_KiCad:
+            case Profile_Metric:
+                Point(X, Y);
+                if(Random() % 32 == 0){ // Slot
+                    Writer.String("G85");
+                    Point(X + abs(RandomCoord())/64, Y);
+                    n++;
+                }
+                Writer.Char('\n');
+                n++;
+                break;
+
+            case Profile_Altium:
+                Point(X, Y);
+                Writer.Char('\n');
+                n++;
+                if(Random() % 64 == 0){ // Repeat along the X axis
+                    int Repeat = 2 + Random() % 30;
+                    Writer.Char('R'); Writer.Int(Repeat);
+                    Coordinate('X', 1000 + Random() % 10000);
+                    Writer.Char('\n');
+                    n += Repeat;
+                }
+                break;
+
+            case Profile_Route:{
+                int R = 1000 + Random() % 5000;
+                switch(Random() % 4){
+                    case 0: // Rectangle
+                        Writer.String("G00"); Point(X, Y); Writer.String("\nM15\n");
+                        Writer.String("G01"); Point(X+R, Y  ); Writer.Char('\n');
+                        Writer.String("G01"); Point(X+R, Y+R); Writer.Char('\n');
+                        Writer.String("G01"); Point(X  , Y+R); Writer.Char('\n');
+                        Writer.String("G01"); Point(X  , Y  ); Writer.String("\nM16\n");
+                        n += 5;
+                        break;
+
+                    case 1: // Semicircles
+                        Writer.String("G00"); Point(X, Y); Writer.String("\nM15\n");
+                        Writer.String("G02"); Point(X+2*R, Y); Coordinate('A', R); Writer.Char('\n');
+                        Writer.String("G03"); Point(X, Y); Writer.String("I-"); Writer.Int(R);
+                        Writer.String("J0\nM16\n");
+                        n += 3;
+                        break;
+
+                    default: // Canned circles
+                        Writer.String(Random() & 1 ? "G32" : "G33");
+                        Point(X, Y); Coordinate('A', R); Writer.Char('\n');
+                        n++;
+                        break;
+                }
+                Writer.String("G05\n");
+                break;
+            }
+
+            case Profile_Holesize:
+                Point(X, Y);
+                Writer.Char('\n');
+                n++;
+                break;
+
+            default:
+                break;
+        }
+    }
+    Hits += n;
+}
+//------------------------------------------------------------------------------
+
+bool GENERATOR::Generate(PROFILE Profile, long long Hits, SINK* Sink){
+    this->Profile = Profile;
+    this->Hits    = 0;
+    State         = 0x9E3779B97F4A7C15ULL + Profile;
+
+    switch(Profile){
+        case Profile_KiCad:
+            IntDigits = 2; FractionDigits = 4; LeadingZeros = false; Decimal = true;
+            break;
+        case Profile_Altium:
+            IntDigits = 2; FractionDigits = 5; LeadingZeros = true;  Decimal = false;
+            break;
+        case Profile_Holesize:
+            IntDigits = 2; FractionDigits = 4; LeadingZeros = true;  Decimal = false;
+            break;
+        default:
+            IntDigits = 3; FractionDigits = 3; LeadingZeros = false; Decimal = false;
+            break;
+    }
+
+    Writer.Open(Sink);
+    Header();
+
+    long long PerTool = Hits / Tools;
+    for(int Tool = 1; Tool <= Tools; Tool++){
+        Block(Tool, Tool == Tools ? Hits - this->Hits : PerTool);
+    }
+    if(Profile == Profile_KiCad) Writer.String("T0\n");
+    Writer.String("M30\n");
+
+    return Writer.Flush();
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,78 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Generator_h
+#define Generator_h
+//------------------------------------------------------------------------------
+
+#include "../Writer.h"
+//------------------------------------------------------------------------------
+
+// Writes synthetic drill files in the dialects that the converter supports.
+// The output is deterministic for a given profile and size.
+class GENERATOR{
+    public:
+        enum PROFILE{
+            Profile_KiCad,    // INCH,TZ with explicit decimal points and G85 slots
+            Profile_Altium,   // ;FILE_FORMAT=2:5, INCH,LZ and R repeats
+            Profile_Metric,   // METRIC,TZ,000.000 with G85 slots
+            Profile_Route,    // G00 to G03 routing and G32 / G33 canned circles
+            Profile_Holesize, // ;Holesize comments, signed LZ, M00 tool changes
+
+            Profile_Count
+        };
+
+        static const char* Name(PROFILE Profile);
+        static bool        Find(const char* Name, PROFILE* Profile);
+
+    private:
+        WRITER Writer;
+
+        unsigned long long State;
+
+        PROFILE Profile;
+        int     IntDigits;
+        int     FractionDigits;
+        bool    LeadingZeros;
+        bool    Decimal;
+        int     Tools;
+
+        unsigned Random();
+        int      RandomCoord();
+
+        void Fixed     (int Value, int Fraction);
+        void Coordinate(char Axis, int Value);
+        void Point     (int X, int Y);
+        void Header    ();
+        void Block     (int Tool, long long Count);
+
+    public:
+        // Number of holes and route segments written by the last call
+        long long Hits;
+
+        GENERATOR();
+
+        // Writes approximately Hits operations; returns false on write error
+        bool Generate(PROFILE Profile, long long Hits, SINK* Sink);
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,106 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Cache.h"
+
+#include <chrono>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+    #include <direct.h>
+#endif
+//------------------------------------------------------------------------------
+
+CACHE::CACHE(const std::string& Directory){
+    this->Directory = Directory;
+
+    if(!Directory.empty()){
+        char Last = Directory[Directory.length()-1];
+        if(Last != '/' && Last != '\\') this->Directory += '/';
+    }
+}
+//------------------------------------------------------------------------------
+
+std::string CACHE::Filename(uint64_t Key) const{
+    char Buffer[0x20];
+    sprintf(Buffer, "%016llx.d2m", (unsigned long long)Key);
+    return Directory + Buffer;
+}
+//------------------------------------------------------------------------------
+
+uint64_t CACHE::GetKey(
+    const char*               Input,
+    size_t                    Length,
+    const CONVERTER::OPTIONS& Options
+){
+    char Buffer[0x80];
+    int  Count = sprintf(
+        Buffer, "Drill2Gerber %d.%d model %u step-repeat %d",
+        MAJOR_VERSION, MINOR_VERSION, MODEL::FormatVersion, (int)Options.StepRepeat
+    );
+    return Hash(Input, Length, Hash(Buffer, Count));
+}
+//------------------------------------------------------------------------------
+
+bool CACHE::Load(uint64_t Key, MODEL* Model) const{
+    if(!Model->Load(Filename(Key).c_str())) return false;
+    if(Model->Key == Key) return true;
+
+    Model->Clear();
+    Model->Diagnostics.clear();
+    return false;
+}
+//------------------------------------------------------------------------------
+
+bool CACHE::Store(const MODEL& Model) const{
+    if(!Directory.empty()){
+        #ifdef _WIN32
+            _mkdir(Directory.c_str());
+        #else
+            mkdir(Directory.c_str(), 0777);
+        #endif
+    }
+
+    // Unique to this thread and process
+    char Buffer[0x40];
+    sprintf(
+        Buffer, ".%llx.tmp",
+        (unsigned long long)(
+            (uintptr_t)&Model ^
+            std::chrono::steady_clock::now().time_since_epoch().count()
+        )
+    );
+    std::string Final     = Filename(Model.Key);
+    std::string Temporary = Final + Buffer;
+
+    if(!Model.Save(Temporary.c_str())){
+        remove(Temporary.c_str());
+        return false;
+    }
+    #ifdef _WIN32
+        remove(Final.c_str()); // rename does not replace on Windows
+    #endif
+    if(rename(Temporary.c_str(), Final.c_str())){
+        remove(Temporary.c_str());
+        return false;
+    }
+    return true;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,61 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Cache_h
+#define Cache_h
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+
+#include <string>
+
+#include "Converter.h"
+#include "Model.h"
+//------------------------------------------------------------------------------
+
+// A directory of converted drill models, keyed by a hash of the input
+// content, the converter version and the conversion options.  The entries
+// are saved models ("<key>.d2m"), so other tools can load them directly.
+class CACHE{
+    private:
+        std::string Directory;
+
+        std::string Filename(uint64_t Key) const;
+
+    public:
+        CACHE(const std::string& Directory);
+
+        static uint64_t GetKey(
+            const char*               Input,
+            size_t                    Length,
+            const CONVERTER::OPTIONS& Options
+        );
+
+        // Returns false on a miss
+        bool Load(uint64_t Key, MODEL* Model) const;
+
+        // Replaces the entry atomically, so that concurrent conversions never
+        // see a partial one.  Returns false on failure.
+        bool Store(const MODEL& Model) const;
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,1013 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Converter.h"
+
+#include <ctype.h>
+#include <stdint.h>
+//------------------------------------------------------------------------------
+
+CONVERTER::OPTIONS::OPTIONS(){
+    StepRepeat = false;
+}
+//------------------------------------------------------------------------------
+
+CONVERTER::CONVERTER(){
+    Plotter = &Gerber;
+    Reset();
+}
+//------------------------------------------------------------------------------
+
+CONVERTER::~CONVERTER(){
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::Reset(){
+    Line.Data   = 0;
+    Line.Length = 0;
+    LineNumber  = 0;
+
+    Format_25        = false;
+    IntDigits        = 3;
+    FractionDigits   = 3;
+    LeadingZeros     = true;
+    RecognisedFormat = false;
+
+    Tool         = 0;
+    MaxTool      = 0;
+    ToolSelected = false;
+    Header       = true;
+
+    pX = pY = 0;
+    X = Y = I = J = R = 0;
+
+    Mode   = Mode_Drill;
+    Z_Axis = Z_Retracted;
+
+    Known     = Known_All;
+    Dependent = false;
+
+    Counted = 0;
+    Statistics.Clear();
+
+    Error = false;
+    Diagnostics.clear();
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::Report(
+    DIAGNOSTIC::LEVEL Level,
+    bool              Unsupported,
+    const char*       Format, ...
+){
+    char Buffer[0x400];
+
+    va_list Arguments;
+    va_start(Arguments, Format);
+    vsnprintf(Buffer, sizeof(Buffer), Format, Arguments);
+    va_end(Arguments);
+
+    DIAGNOSTIC Diagnostic;
+    Diagnostic.Level       = Level;
+    Diagnostic.LineNumber  = LineNumber;
+    Diagnostic.Unsupported = Unsupported;
+    Diagnostic.Message     = Buffer;
+    Diagnostics.push_back(Diagnostic);
+
+    if(Level == DIAGNOSTIC::Error) Error = true;
+}
+//------------------------------------------------------------------------------
+
+bool CONVERTER::IsLine(const char* String){
+    int j;
+    for(j = 0; Line[j] && String[j]; j++){
+        if(Line[j] != String[j]) return false;
+    }
+    if(String[j]       ) return false; // Still characters left
+    if(Line  [j] >= ' ') return false; // Still printable characters left
+    return true;
+}
+//------------------------------------------------------------------------------
+
+bool CONVERTER::Keyword(int* Index, const char* String){
+    int j;
+
+    for(j = 0; Line[*Index+j] && String[j]; j++){
+        if(Line[*Index+j] != String[j]) return false;
+    }
+    if(String[j]) return false; // Still characters left
+
+    *Index += j;
+    return true;
+}
+//------------------------------------------------------------------------------
+
+int CONVERTER::GetTool(int* ToolChars, int Index){
+    int j;
+    int Tool = 0;
+
+    for(j = Index; Line[j] >= '0' && Line[j] <= '9'; j++){
+        Tool = 10*Tool + Line[j] - '0';
+    }
+
+    *ToolChars = j-Index;
+    return Tool;
+}
+//------------------------------------------------------------------------------
+
+/* The drill file format supports a maximum of 6 digits:
+
+https://web.archive.org/web/20071030075236/http://www.excellon.com/manuals/program.htm */
+
+// The digits and decimal points of a coordinate
+struct NUMBER{
+    uint32_t Value;    // Of the digits, modulo 2^32
+    int      Digits;
+    int      PointPos; // Digits after the last point
+    bool     ExplicitPoint;
+    int      Length;
+};
+//------------------------------------------------------------------------------
+
+static inline void ScanNumber(const LINE& Line, int j, NUMBER* Number){
+    uint32_t Value = 0;
+    int      Start = j;
+
+    Number->Digits        = 0;
+    Number->PointPos      = 0;
+    Number->ExplicitPoint = false;
+
+    while(Line[j]){
+        if(Line[j] >= '0' && Line[j] <= '9'){
+            Value = 10*Value + Line[j] - '0';
+            Number->Digits  ++;
+            Number->PointPos++;
+
+        }else if(Line[j] == '.'){
+            Number->ExplicitPoint = true;
+            Number->PointPos      = 0;
+
+        }else{
+            break;
+        }
+        j++;
+    }
+    Number->Value  = Value;
+    Number->Length = j - Start;
+}
+//------------------------------------------------------------------------------
+
+// Multiplies by 10^Exponent, modulo 2^32
+static inline uint32_t Scale(uint32_t Value, int Exponent){
+    static const uint32_t Powers[10] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+    };
+    while(Exponent > 9){
+        Value    *= Powers[9];
+        Exponent -= 9;
+    }
+    return Value * Powers[Exponent];
+}
+//------------------------------------------------------------------------------
+
+int CONVERTER::ConvertCoord(int Index, int* ValueOut){
+    bool   Sign = false;
+    NUMBER Number;
+
+    int j = Index;
+    if(Line[j] == '+'){
+        j++;
+    }else if(Line[j] == '-'){
+        Sign = true;
+        j++;
+    }
+
+    ScanNumber(Line, j, &Number);
+    uint32_t Value = Number.Value;
+    j += Number.Length;
+
+    // Get the real value (scaled with 10^FractionDigits)
+    if(Number.ExplicitPoint){
+        if(Number.PointPos < FractionDigits){
+            Value = Scale(Value, FractionDigits - Number.PointPos);
+        }
+
+    // If leading zeros are specified, add the trailing ones
+    }else if(LeadingZeros){
+        if(Number.Digits < IntDigits + FractionDigits){
+            Value = Scale(Value, IntDigits + FractionDigits - Number.Digits);
+        }
+    }
+
+    // Output is always with trailing zeros
+    *ValueOut = Sign ? -(int)Value : (int)Value;
+
+    j -= Index;
+    if(j == 0){ // Prevent infinite loop
+        Report(DIAGNOSTIC::Error, false, "Error while converting coordinate");
+        j++;
+    }
+    return j;
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::GetFormat(int Index){
+    IntDigits = 0;
+    while(Line[Index] == '0'){
+        Index++;
+        IntDigits++;
+    }
+
+    if(Line[Index] != '.') return;
+    Index++;
+
+    FractionDigits = 0;
+    while(Line[Index] == '0'){
+        Index++;
+        FractionDigits++;
+    }
+}
+//------------------------------------------------------------------------------
+
+// Arcs are guaranteed to be less than 180 deg
+void CONVERTER::DoArc(double pX, double pY, double X, double Y, double R, bool CCW){
+    Counts().Arcs++;
+
+    double x = X - pX;
+    double y = Y - pY;
+
+    double e = CCW ? 1 : -1;
+    double d = x*x + y*y;
+    double h = R*R - d/4.0;
+
+    if(h <= 0.0){ // Invalid radius
+        x = (X - pX)/2.0;
+        y = (Y - pY)/2.0;
+
+    }else{
+        d = sqrt(d);
+        h = sqrt(h);
+
+        x = (X - pX)/2.0 - e * h * ((Y - pY) / d);
+        y = (Y - pY)/2.0 + e * h * ((X - pX) / d);
+    }
+
+    Plotter->Arc(
+        (int)round(X), (int)round(Y),
+        (int)round(x), (int)round(y)
+    );
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::DoCoord(int Index){
+    // Used to detect if this sets arc parameters, or includes a routing command
+    bool ParameterOnly = false;
+
+    if(!ToolSelected){
+        Plotter->Select(Tool+10);
+        ToolSelected = true;
+    }
+
+    while(Line[Index]){
+        switch(Line[Index]){
+            case 'X':
+                ParameterOnly = false;
+                Index ++;
+                Index += ConvertCoord(Index, &X);
+                Known |= Known_X;
+                break;
+
+            case 'Y':
+                ParameterOnly = false;
+                Index ++;
+                Index += ConvertCoord(Index, &Y);
+                Known |= Known_Y;
+                break;
+
+            case 'I':
+                if(Index == 0) ParameterOnly = true;
+                Index ++;
+                Index += ConvertCoord(Index, &I);
+                R = round(sqrt((double)I*(double)I + (double)J*(double)J));
+                Known |= Known_I;
+                if(Known & Known_J) Known |=  Known_R;
+                else                Known &= ~Known_R;
+                break;
+
+            case 'J':
+                if(Index == 0) ParameterOnly = true;
+                Index ++;
+                Index += ConvertCoord(Index, &J);
+                R = round(sqrt((double)I*(double)I + (double)J*(double)J));
+                Known |= Known_J;
+                if(Known & Known_I) Known |=  Known_R;
+                else                Known &= ~Known_R;
+                break;
+
+            case 'A':
+                if(Index == 0) ParameterOnly = true;
+                Index ++;
+                Index += ConvertCoord(Index, &R);
+                Known |= Known_R;
+                break;
+
+            case 'G':
+                if(Line[Index+1] == '8' && Line[Index+2] == '5'){
+                    Need(Known_X | Known_Y);
+                    Counts().Slots++;
+                    Plotter->Move(X, Y);
+                    pX = X;
+                    pY = Y;
+                    Known |= Known_P;
+
+                    Z_Axis = Z_Routing;
+                    Mode   = Mode_Route_Linear;
+                    DoCoord(Index+3);
+                    Z_Axis = Z_Retracted;
+                    Mode   = Mode_Drill;
+                }else{
+                    char Code[] = {'G', Line[Index+1], Line[Index+2], 0};
+                    Statistics.Unsupported[Code]++;
+                    Report(DIAGNOSTIC::Error, true, "Invalid embedded G-command");
+                }
+                return;
+
+            default:
+                Line.Length = Index;
+                break;
+        }
+    }
+
+    if(ParameterOnly){
+        pX = X;
+        pY = Y;
+        if((Known & (Known_X | Known_Y)) == (Known_X | Known_Y)) Known |=  Known_P;
+        else                                                   Known &= ~Known_P;
+        return;
+    }
+
+    Need(Known_X | Known_Y);
+
+    switch(Mode){
+        case Mode_Drill:
+            Counts().Hits++;
+            Plotter->Flash(X, Y);
+            break;
+
+        case Mode_Route_Canned_CW:
+        case Mode_Route_Canned_CCW:
+            Need(Known_R);
+            Counts().Arcs++;
+            Plotter->Circle(X, Y, R);
+            break;
+
+        default:
+            if(Z_Axis == Z_Routing){
+                switch(Mode){
+                    case Mode_Route_Move:
+                    case Mode_Route_Linear:
+                        Counts().Routes++;
+                        Plotter->Draw(X, Y);
+                        break;
+
+                    case Mode_Route_CW:
+                        Need(Known_R | Known_P);
+                        DoArc(pX, pY, X, Y, R, false);
+                        break;
+
+                    case Mode_Route_CCW:
+                        Need(Known_R | Known_P);
+                        DoArc(pX, pY, X, Y, R, true);
+                        break;
+
+                    default:
+                        break;
+                }
+            }else{ // Move only
+                Plotter->Move(X, Y);
+            }
+            break;
+    }
+
+    pX = X;
+    pY = Y;
+    Known |= Known_P;
+}
+//------------------------------------------------------------------------------
+
+// Finds the diameter following the 'C' in a tool definition
+static void GetToolDiameter(const LINE& Line, int n, int* Start, int* Length){
+    while(Line[n]){
+        if(Line[n] == 'C'){
+            n++;
+            break;
+        }
+        n++;
+    }
+    *Start = n;
+    while((Line[n] >= '0' && Line[n] <= '9') || Line[n] == '.') n++;
+    *Length = n - *Start;
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::DoRepeat(){
+    int dX = 0, dY = 0;
+    int Count = 0;
+    int Index = 0;
+
+    if(!ToolSelected){
+        Plotter->Select(Tool+10);
+        ToolSelected = true;
+    }
+
+    while(Line[Index]){
+        switch(Line[Index]){
+            case 'X':
+                Index ++;
+                Index += ConvertCoord(Index, &dX);
+                break;
+
+            case 'Y':
+                Index ++;
+                Index += ConvertCoord(Index, &dY);
+                break;
+
+            case 'R':
+                Index ++;
+                while(Line[Index] >= '0' && Line[Index] <= '9'){
+                    Count *= 10;
+                    Count += Line[Index++] - '0';
+                }
+                break;
+
+            default:
+                Line.Length = Index;
+                break;
+        }
+    }
+
+    Need(Known_P);
+
+    Counts().Repeats++;
+    Counts().Hits += Count;
+
+    // A step-and-repeat block can only step along the axes, and is longer
+    // than the unrolled version for fewer than three holes
+    if(Options.StepRepeat && Count > 2 && (dX == 0) != (dY == 0)){
+        // The parser position ends on the last hole, as when unrolled
+        int LastX = pX + Count*dX;
+        int LastY = pY + Count*dY;
+
+        // Steps must be positive, so start from the other end if required
+        int X = dX < 0 ? LastX : pX + dX;
+        int Y = dY < 0 ? LastY : pY + dY;
+
+        Plotter->StepRepeat(dX ? Count : 1, dY ? Count : 1, abs(dX), abs(dY));
+        Plotter->Flash(X, Y);
+        Plotter->EndStepRepeat();
+
+        pX = LastX;
+        pY = LastY;
+        return;
+    }
+
+    int X = pX, Y = pY;
+    for(int n = 0; n < Count; n++){
+        X += dX;
+        Y += dY;
+        Plotter->Flash(X, Y);
+        pX = X;
+        pY = Y;
+    }
+}
+//------------------------------------------------------------------------------
+
+int CONVERTER::WhiteSpace(int Index){
+    while(Line[Index] == ' ') Index++;
+    return Index;
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::GetHolesize(int Index){
+    int CharCount;
+
+    Index = WhiteSpace(Index);
+
+    int Tool = GetTool(&CharCount, Index);
+    Index += CharCount;
+
+    if(MaxTool < Tool) MaxTool = Tool;
+    // printf("Tool = %d\n", Tool);
+
+    while(Line[Index] && (Line[Index] < '0' || Line[Index] > '9')) Index++;
+    int SizeStart = Index;
+    while((Line[Index] && Line[Index] >= '0' && Line[Index] <= '9') || Line[Index] == '.') Index++;
+    int SizeStop = Index;
+
+    // printf("Size = '");
+    // for(int n = SizeStart; n <= SizeStop; n++) printf("%c", Line[n]);
+    // printf("'\n");
+
+    if(SizeStart == SizeStop) return;
+
+    while(Line[Index]){
+        if(Keyword(&Index, "PLATED") || Keyword(&Index, "NON_PLATED")) break;
+        Index++;
+    }
+
+    Index = WhiteSpace(Index);
+
+    bool isMetric = false;
+    if(Keyword(&Index, "MM")){
+        isMetric = true;
+
+    }else if(Keyword(&Index, "MILS")){
+        isMetric = false;
+
+    }else{
+        return;
+    }
+
+    if(!RecognisedFormat){
+        if(isMetric){
+            Report(DIAGNOSTIC::Warning, false,
+                "Hole size specified in header, but the coordinate "
+                "format is not yet specified.  Assuming metric 5.5"
+            );
+            IntDigits      = 5;
+            FractionDigits = 5;
+            Plotter->Format(true, IntDigits, FractionDigits);
+        }else{
+            Report(DIAGNOSTIC::Warning, false,
+                "Hole size specified in header, but the coordinate "
+                "format is not yet specified.  Assuming inch 2.4"
+            );
+            IntDigits      = 2;
+            FractionDigits = 4;
+            Plotter->Format(false, IntDigits, FractionDigits);
+        }
+        RecognisedFormat = true;
+    }
+
+    // The character after the size is included, as it always has been
+    Plotter->Aperture(Tool+10, Line.Data + SizeStart, SizeStop - SizeStart + 1);
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::ParseComment(){
+    int Index = 1;
+
+    Index = WhiteSpace(Index);
+    if(Keyword(&Index, "FILE_FORMAT")){
+        if(Keyword(&Index, "=2:5") && !Line[Index]) Format_25 = true;
+
+    }else if(Keyword(&Index, "Holesize")){
+        GetHolesize(Index);
+    }
+}
+//------------------------------------------------------------------------------
+
+// Counts a line that is not converted by its leading keyword, for example
+// "ICI" of "ICI,OFF" or "M47" of "M47,Message"
+void CONVERTER::IgnoreKeyword(){
+    char Name[16];
+    int  Length = 0;
+
+    while(Length < (int)sizeof(Name)-1 && isalnum((unsigned char)Line[Length])){
+        Name[Length] = Line[Length];
+        Length++;
+    }
+    if(!Length) return;
+    Name[Length] = 0;
+
+    Statistics.Ignored[Name]++;
+}
+//------------------------------------------------------------------------------
+
+// Body commands
+void CONVERTER::DrillMode(){
+    Z_Axis = Z_Retracted;
+    Mode   = Mode_Drill;
+    Plotter->Linear();
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::RouteMove(){
+    Mode = Mode_Route_Move;
+    DoCoord(3);
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::RouteLinear(){
+    Mode = Mode_Route_Linear;
+    Plotter->Linear();
+    DoCoord(3);
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::RouteCW(){
+    Mode = Mode_Route_CW;
+    Plotter->Circular(false);
+    DoCoord(3);
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::RouteCCW(){
+    Mode = Mode_Route_CCW;
+    Plotter->Circular(true);
+    DoCoord(3);
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::CannedCW(){
+    Mode = Mode_Route_Canned_CW;
+    Plotter->Circular(false);
+    DoCoord(3);
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::CannedCCW(){
+    Mode = Mode_Route_Canned_CCW;
+    Plotter->Circular(true);
+    DoCoord(3);
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::AbsoluteMode(){
+    Statistics.Ignored["G90"]++;
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::ZeroSet(){
+    Statistics.Ignored["G93"]++;
+    Report(DIAGNOSTIC::Warning, false, "Zero-set command (G93) ignored");
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::EnterHeader(){
+    Header = true;
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::EndOfProgram(){
+    Plotter->End();
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::RouterDown(){
+    Z_Axis = Z_Routing;
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::RouterUp(){
+    Z_Axis = Z_Retracted;
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::NextTool(){
+    Tool++;
+    if(Tool > 0 && Tool <= MaxTool) Plotter->Select(Tool+10);
+    ToolSelected = true;
+}
+//------------------------------------------------------------------------------
+
+// The handler of every code, or null if unsupported.  A new command needs
+// only a handler and an entry here.
+constexpr CONVERTER::COMMAND CONVERTER::GCommand(int Code){
+    return Code ==  0 ? &CONVERTER::RouteMove    :
+           Code ==  1 ? &CONVERTER::RouteLinear  :
+           Code ==  2 ? &CONVERTER::RouteCW      :
+           Code ==  3 ? &CONVERTER::RouteCCW     :
+           Code ==  5 ? &CONVERTER::DrillMode    :
+           Code == 32 ? &CONVERTER::CannedCW     :
+           Code == 33 ? &CONVERTER::CannedCCW    :
+           Code == 81 ? &CONVERTER::DrillMode    :
+           Code == 90 ? &CONVERTER::AbsoluteMode :
+           Code == 93 ? &CONVERTER::ZeroSet      :
+           nullptr;
+}
+//------------------------------------------------------------------------------
+
+constexpr CONVERTER::COMMAND CONVERTER::MCommand(int Code){
+    return Code ==  0 ? &CONVERTER::NextTool     :
+           Code == 15 ? &CONVERTER::RouterDown   :
+           Code == 16 ? &CONVERTER::RouterUp     :
+           Code == 17 ? &CONVERTER::RouterUp     :
+           Code == 30 ? &CONVERTER::EndOfProgram :
+           Code == 48 ? &CONVERTER::EnterHeader  :
+           nullptr;
+}
+//------------------------------------------------------------------------------
+
+// Dense tables indexed by the code, built at compile time
+#define COMMANDS(Lookup, Tens)                               \
+    Lookup(10*Tens+0), Lookup(10*Tens+1), Lookup(10*Tens+2), \
+    Lookup(10*Tens+3), Lookup(10*Tens+4), Lookup(10*Tens+5), \
+    Lookup(10*Tens+6), Lookup(10*Tens+7), Lookup(10*Tens+8), \
+    Lookup(10*Tens+9)
+
+const CONVERTER::COMMAND CONVERTER::GCommands[100] = {
+    COMMANDS(GCommand, 0), COMMANDS(GCommand, 1), COMMANDS(GCommand, 2),
+    COMMANDS(GCommand, 3), COMMANDS(GCommand, 4), COMMANDS(GCommand, 5),
+    COMMANDS(GCommand, 6), COMMANDS(GCommand, 7), COMMANDS(GCommand, 8),
+    COMMANDS(GCommand, 9)
+};
+
+const CONVERTER::COMMAND CONVERTER::MCommands[100] = {
+    COMMANDS(MCommand, 0), COMMANDS(MCommand, 1), COMMANDS(MCommand, 2),
+    COMMANDS(MCommand, 3), COMMANDS(MCommand, 4), COMMANDS(MCommand, 5),
+    COMMANDS(MCommand, 6), COMMANDS(MCommand, 7), COMMANDS(MCommand, 8),
+    COMMANDS(MCommand, 9)
+};
+
+#undef COMMANDS
+//------------------------------------------------------------------------------
+
+void CONVERTER::ConvertLine(){
+    int Code;
+    int CharCount;
+    int DiameterStart, DiameterLength;
+
+    if(Header){
+        switch(Line[0]){
+            case 'I':
+                if(Line[1] == 'N' && Line[2] == 'C' && Line[3] == 'H'){
+                    IntDigits        = 2;
+                    FractionDigits   = 4;
+                    LeadingZeros     = true;
+                    RecognisedFormat = true;
+
+                    if(Format_25) FractionDigits = 5;
+
+                    if     (Line[5] == 'T') LeadingZeros = false;
+                    if     (Line[5] == '0') GetFormat(5);
+                    else if(Line[8] == '0') GetFormat(8);
+
+                    Plotter->Format(false, IntDigits, FractionDigits);
+
+                }else{
+                    IgnoreKeyword();
+                }
+                break;
+
+            case 'M':
+                if(Line[1] == 'E' && Line[2] == 'T' && Line[3] == 'R'){
+                    IntDigits        = 3;
+                    FractionDigits   = 3;
+                    LeadingZeros     = true;
+                    RecognisedFormat = true;
+
+                    if     (Line[ 7] == 'T') LeadingZeros = false;
+                    if     (Line[ 7] == '0') GetFormat( 7);
+                    else if(Line[10] == '0') GetFormat(10);
+
+                    Plotter->Format(true, IntDigits, FractionDigits);
+
+                }else if(GetCode() != 48){ // Also read in the header
+                    IgnoreKeyword();
+                }
+                break;
+
+            case 'T': // Define drill width
+                Tool = GetTool(&CharCount);
+                GetToolDiameter(Line, CharCount, &DiameterStart, &DiameterLength);
+                Plotter->Aperture(Tool+10, Line.Data + DiameterStart, DiameterLength);
+                if(MaxTool < Tool) MaxTool = Tool;
+                break;
+
+            case '%':
+                Tool   = 1;
+                Header = false;
+                Plotter->Begin();
+                break;
+
+            case ';':
+                ParseComment();
+                break;
+
+            default:
+                IgnoreKeyword();
+                break;
+        }
+    }else{
+        switch(Line[0]){
+            case 'T':
+                Tool = GetTool(&CharCount);
+                if(Tool > 0 && Tool <= MaxTool) Plotter->Select(Tool+10);
+                ToolSelected = true;
+                break;
+
+            case 'X':
+            case 'Y':
+            case 'I':
+            case 'J':
+            case 'A':
+                DoCoord(0);
+                break;
+
+            case 'R':
+                DoRepeat();
+                break;
+
+            case 'M':
+                // The whole line must be the code
+                Code = GetCode();
+                if(Code >= 0 && Line[3] < ' ' && MCommands[Code]){
+                    (this->*MCommands[Code])();
+
+                }else{
+                    IgnoreKeyword();
+                }
+                break;
+
+            case 'G':
+                Code = GetCode();
+                if(Code >= 0 && GCommands[Code]){
+                    (this->*GCommands[Code])();
+
+                }else{
+                    char Name[] = {'G', Line[1], Line[2], 0};
+                    Statistics.Unsupported[Name]++;
+                    Report(DIAGNOSTIC::Warning, true,
+                        "Unsupported code: G%c%c",
+                        Line[1], Line[2]
+                    );
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::Begin(SINK* Output){
+    Gerber.Open(Output);
+    Begin(&Gerber);
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::Begin(PLOTTER* Output){
+    Reset();
+    Plotter = Output;
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::Convert(const LINE& Line){
+    this->Line = Line;
+    LineNumber++;
+    ConvertLine();
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::Flush(){
+    if(!Plotter->Flush() && !Error){
+        Report(DIAGNOSTIC::Error, false, "Cannot write to the output");
+    }
+}
+//------------------------------------------------------------------------------
+
+bool CONVERTER::End(){
+    Flush();
+
+    LineNumber = 0;
+    if(!RecognisedFormat){
+        Report(DIAGNOSTIC::Error, true, "Unrecognised drill coordinate format");
+    }
+
+    Gerber.Open(0);
+
+    return !Error;
+}
+//------------------------------------------------------------------------------
+
+bool CONVERTER::InHeader() const{
+    return Header;
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::GetState(STATE* State) const{
+    State->Format_25        = Format_25;
+    State->IntDigits        = IntDigits;
+    State->FractionDigits   = FractionDigits;
+    State->LeadingZeros     = LeadingZeros;
+    State->RecognisedFormat = RecognisedFormat;
+
+    State->Tool         = Tool;
+    State->MaxTool      = MaxTool;
+    State->ToolSelected = ToolSelected;
+    State->Header       = Header;
+
+    State->pX = pX;
+    State->pY = pY;
+    State->X  = X;
+    State->Y  = Y;
+    State->I  = I;
+    State->J  = J;
+    State->R  = R;
+
+    State->Mode   = Mode;
+    State->Z_Axis = Z_Axis;
+}
+//------------------------------------------------------------------------------
+
+void CONVERTER::SetState(const STATE& State, int LineNumber, bool Speculative){
+    Format_25        = State.Format_25;
+    IntDigits        = State.IntDigits;
+    FractionDigits   = State.FractionDigits;
+    LeadingZeros     = State.LeadingZeros;
+    RecognisedFormat = State.RecognisedFormat;
+
+    Tool         = State.Tool;
+    MaxTool      = State.MaxTool;
+    ToolSelected = State.ToolSelected;
+    Header       = State.Header;
+
+    pX = State.pX;
+    pY = State.pY;
+    X  = State.X;
+    Y  = State.Y;
+    I  = State.I;
+    J  = State.J;
+    R  = State.R;
+
+    Mode   = State.Mode;
+    Z_Axis = State.Z_Axis;
+
+    this->LineNumber = LineNumber;
+
+    Known     = Speculative ? 0 : Known_All;
+    Dependent = false;
+}
+//------------------------------------------------------------------------------
+
+unsigned CONVERTER::GetKnown() const{
+    return Known;
+}
+//------------------------------------------------------------------------------
+
+bool CONVERTER::Convert(READER* Input, SINK* Output){
+    Gerber.Open(Output);
+    return Convert(Input, &Gerber);
+}
+//------------------------------------------------------------------------------
+
+bool CONVERTER::Convert(READER* Input, PLOTTER* Output){
+    LINE      Line;
+    STOPWATCH Watch;
+
+    // Reading and writing happen while parsing, and are booked apart
+    PHASE_TIME ReadBefore    = Input->Time;
+    PHASE_TIME WrittenBefore = OutputTime();
+
+    Begin(Output);
+    while(Input->ReadLine(Line)) Convert(Line);
+    Watch.Split(Statistics.Parse);
+
+    PHASE_TIME Read    = Input->Time;
+    PHASE_TIME Written = OutputTime();
+    Read   .Subtract(ReadBefore   );
+    Written.Subtract(WrittenBefore);
+
+    Statistics.Read .Add     (Read   );
+    Statistics.Emit .Add     (Written);
+    Statistics.Parse.Subtract(Read   );
+    Statistics.Parse.Subtract(Written);
+
+    bool Result = End();
+    Watch.Split(Statistics.Emit);
+    return Result;
+}
+//------------------------------------------------------------------------------
+
+bool CONVERTER::Convert(SOURCE* Input, SINK* Output){
+    READER Reader;
+    Reader.Open(Input);
+    return Convert(&Reader, Output);
+}
+//------------------------------------------------------------------------------
+
+bool CONVERTER::Convert(const char* Input, size_t Length, SINK* Output){
+    READER Reader;
+    Reader.Open(Input, Length);
+    return Convert(&Reader, Output);
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,266 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Converter_h
+#define Converter_h
+//------------------------------------------------------------------------------
+
+#include <math.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "Gerber.h"
+#include "Reader.h"
+#include "Statistics.h"
+#include "Stream.h"
+//------------------------------------------------------------------------------
+
+class THREAD_POOL;
+//------------------------------------------------------------------------------
+
+struct DIAGNOSTIC{
+    enum LEVEL{
+        Warning,
+        Error
+    } Level;
+
+    int  LineNumber; // 1-based; 0 when not associated with a line
+    bool Unsupported; // The input uses something this converter cannot handle
+
+    std::string Message;
+};
+//------------------------------------------------------------------------------
+
+// All the parser state of a single conversion.  Nothing is shared between
+// instances, so different files can be converted on different threads.
+class CONVERTER{
+    public:
+        enum MODE{
+            Mode_Drill,
+            Mode_Route_Move,
+            Mode_Route_Linear,
+            Mode_Route_CW,
+            Mode_Route_CCW,
+            Mode_Route_Canned_CW,
+            Mode_Route_Canned_CCW,
+        };
+
+        enum Z_AXIS{
+            Z_Routing,
+            Z_Retracted
+        };
+
+        struct OPTIONS{
+            // Write R (repeat hole) commands as Gerber step-and-repeat
+            // blocks where possible, rather than one flash per hole
+            bool StepRepeat;
+
+            OPTIONS();
+        };
+
+        // Parser state between lines, used to convert a file in parts
+        struct STATE{
+            bool Format_25;
+            int  IntDigits;
+            int  FractionDigits;
+            bool LeadingZeros;
+            bool RecognisedFormat;
+
+            int  Tool;
+            int  MaxTool;
+            bool ToolSelected;
+            bool Header;
+
+            int pX, pY;
+            int X, Y, I, J, R;
+
+            MODE   Mode;
+            Z_AXIS Z_Axis;
+        };
+
+        // Coordinate state that is not known at the start of a speculative
+        // part, until the part sets it
+        enum KNOWN{
+            Known_X   = 0x01,
+            Known_Y   = 0x02,
+            Known_I   = 0x04,
+            Known_J   = 0x08,
+            Known_R   = 0x10,
+            Known_P   = 0x20, // pX and pY
+            Known_All = 0x3F
+        };
+    //--------------------------------------------------------------------------
+
+    private:
+        GERBER_WRITER Gerber;  // Used for output to a sink
+        PLOTTER*      Plotter; // Receives the output
+
+        LINE Line;
+        int  LineNumber;
+
+        bool Format_25;
+        int  IntDigits;
+        int  FractionDigits;
+        bool LeadingZeros;
+
+        int  Tool;
+        int  MaxTool;
+        bool ToolSelected;
+        bool Header;
+
+        int pX, pY;
+
+        // Coordinate and arc parameters, which are modal
+        int X, Y, I, J, R;
+
+        MODE   Mode;
+        Z_AXIS Z_Axis;
+
+        unsigned Known;
+
+        // Counters of the tool last counted, to avoid a look-up per hit
+        int          CountedTool;
+        TOOL_COUNTS* Counted;
+
+        inline TOOL_COUNTS& Counts(){
+            if(!Counted || CountedTool != Tool){
+                Counted     = &Statistics.Tools[Tool];
+                CountedTool = Tool;
+            }
+            return *Counted;
+        }
+
+        // Flags the conversion as dependent on unknown state
+        inline void Need(unsigned Bits){
+            if((Known & Bits) != Bits) Dependent = true;
+        }
+
+        void Reset();
+
+        void Report(DIAGNOSTIC::LEVEL Level, bool Unsupported, const char* Format, ...);
+
+        bool IsLine      (const char* String);
+        bool Keyword     (int* Index, const char* String);
+        int  GetTool     (int* ToolChars, int Index = 1);
+        int  ConvertCoord(int Index, int* ValueOut);
+        void GetFormat   (int Index);
+        void DoArc       (double pX, double pY, double X, double Y, double R, bool CCW);
+        void DoCoord     (int Index);
+        void DoRepeat    ();
+        int  WhiteSpace  (int Index);
+        void GetHolesize (int Index);
+        void ParseComment();
+        void ConvertLine ();
+        void IgnoreKeyword();
+
+        // The two digits after the command letter, or -1
+        inline int GetCode() const{
+            unsigned Tens  = Line[1] - '0';
+            unsigned Units = Line[2] - '0';
+            if(Tens > 9 || Units > 9) return -1;
+            return 10*Tens + Units;
+        }
+
+        // Handlers of the G and M codes in the body
+        typedef void (CONVERTER::*COMMAND)();
+        static constexpr COMMAND GCommand(int Code);
+        static constexpr COMMAND MCommand(int Code);
+        static const     COMMAND GCommands[100];
+        static const     COMMAND MCommands[100];
+
+        void DrillMode   ();
+        void RouteMove   ();
+        void RouteLinear ();
+        void RouteCW     ();
+        void RouteCCW    ();
+        void CannedCW    ();
+        void CannedCCW   ();
+        void AbsoluteMode();
+        void ZeroSet     ();
+        void EnterHeader ();
+        void EndOfProgram();
+        void RouterDown  ();
+        void RouterUp    ();
+        void NextTool    ();
+
+    public:
+        OPTIONS Options;
+
+        bool Error;
+        bool RecognisedFormat;
+
+        // Set when a speculative part used state that it did not set itself
+        bool Dependent;
+
+        // In the order in which they occurred
+        std::vector<DIAGNOSTIC> Diagnostics;
+
+        STATISTICS Statistics;
+
+        CONVERTER();
+       ~CONVERTER();
+
+        // Converts the whole input and returns false on error.  The state is
+        // reset at the start, so the object can be reused.  Output to a sink
+        // is in Gerber format.
+        bool Convert(READER*     Input,                SINK*    Output);
+        bool Convert(READER*     Input,                PLOTTER* Output);
+        bool Convert(SOURCE*     Input,                SINK*    Output);
+        bool Convert(const char* Input, size_t Length, SINK*    Output);
+
+        // Converts memory-backed input in parallel parts on the pool, and
+        // falls back to a pipelined or serial conversion otherwise
+        bool Convert(READER* Input, SINK*    Output, THREAD_POOL* Pool);
+        bool Convert(READER* Input, PLOTTER* Output, THREAD_POOL* Pool);
+
+        // Converts on three threads: one reads the input, this one parses it
+        // and one plots the output, with bounded queues in between
+        bool ConvertPipelined(READER* Input, SINK*    Output);
+        bool ConvertPipelined(READER* Input, PLOTTER* Output);
+
+        // Incremental interface: Begin, then Convert every line, then End.
+        // Flush passes the output so far on to the sink or plotter.
+        void Begin  (SINK*    Output);
+        void Begin  (PLOTTER* Output);
+        void Convert(const LINE& Line);
+        void Flush  ();
+        bool End    ();
+
+        bool InHeader() const;
+
+        void GetState(STATE* State) const;
+
+        // Continues from the given state and line number.  A speculative
+        // continuation treats the coordinate state as unknown and sets
+        // Dependent if it is used before being set.
+        void SetState(const STATE& State, int LineNumber, bool Speculative);
+
+        // The parts of the coordinate state that are known
+        unsigned GetKnown() const;
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
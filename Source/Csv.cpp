@@ -0,0 +1,99 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Csv.h"
+//------------------------------------------------------------------------------
+
+CSV_WRITER::CSV_WRITER(size_t BufferSize): Writer(BufferSize){
+    Open(0);
+}
+//------------------------------------------------------------------------------
+
+void CSV_WRITER::Open(SINK* Sink){
+    Writer.Open(Sink);
+
+    Metric         = true;
+    FractionDigits = 3;
+    Started        = false;
+    Prefix         = ",0,";
+
+    Apertures.clear();
+}
+//------------------------------------------------------------------------------
+
+void CSV_WRITER::Start(){
+    if(Started) return;
+
+    Writer.String(Metric ? "tool,diameter_mm,x_mm,y_mm\n"
+                         : "tool,diameter_in,x_in,y_in\n");
+    Started = true;
+}
+//------------------------------------------------------------------------------
+
+bool CSV_WRITER::Close(){
+    Start();
+    return Writer.Flush();
+}
+//------------------------------------------------------------------------------
+
+bool CSV_WRITER::Flush(){
+    return Writer.Flush();
+}
+//------------------------------------------------------------------------------
+
+void CSV_WRITER::Format(bool Metric, int IntDigits, int FractionDigits){
+    this->Metric         = Metric;
+    this->FractionDigits = FractionDigits;
+}
+//------------------------------------------------------------------------------
+
+void CSV_WRITER::Aperture(int Code, const char* Diameter, int Length){
+    std::string Value(Diameter, Length);
+    Apertures[Code] = atof(Value.c_str());
+}
+//------------------------------------------------------------------------------
+
+void CSV_WRITER::Begin(){
+    Start();
+}
+//------------------------------------------------------------------------------
+
+void CSV_WRITER::End()                                                      {}
+//------------------------------------------------------------------------------
+
+void CSV_WRITER::Select(int Code){
+    auto   Found    = Apertures.find(Code);
+    double Diameter = Found == Apertures.end() ? 0 : Found->second;
+
+    char Buffer[48];
+    snprintf(Buffer, sizeof(Buffer), "T%02d,%.10g,", Code - 10, Diameter);
+    Prefix = Buffer;
+}
+//------------------------------------------------------------------------------
+
+void CSV_WRITER::Linear       ()                                            {}
+void CSV_WRITER::Circular     (bool CCW)                                    {}
+void CSV_WRITER::Move         (int X, int Y)                                {}
+void CSV_WRITER::Draw         (int X, int Y)                                {}
+void CSV_WRITER::Arc          (int X, int Y, int I, int J)                  {}
+void CSV_WRITER::Circle       (int X, int Y, int R)                         {}
+void CSV_WRITER::StepRepeat   (int CountX, int CountY, int StepX, int StepY){}
+void CSV_WRITER::EndStepRepeat()                                            {}
+//------------------------------------------------------------------------------
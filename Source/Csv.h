@@ -0,0 +1,86 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Csv_h
+#define Csv_h
+//------------------------------------------------------------------------------
+
+#include <stdlib.h>
+
+#include <map>
+#include <string>
+
+#include "Plotter.h"
+#include "Writer.h"
+//------------------------------------------------------------------------------
+
+// Lists the drill hits as comma-separated values, one hit per line:
+// "tool,diameter,x,y" in mm or inches, as given by the header line.  Routes
+// are not hits, so they are left out.
+//
+// Step-and-repeat blocks are not supported, and must be unrolled first (see
+// UNROLL).
+class CSV_WRITER: public PLOTTER{
+    private:
+        WRITER Writer;
+
+        bool Metric;
+        int  FractionDigits;
+        bool Started; // The header line is written
+
+        std::map<int, double> Apertures; // Diameters in mm or inches
+
+        // "<Tool>,<Diameter>," of the selected tool
+        std::string Prefix;
+
+        void Start();
+
+    public:
+        CSV_WRITER(size_t BufferSize = 0x40000);
+
+        void Open (SINK* Sink);
+        bool Close(); // Returns false on error
+        bool Flush();
+
+        void Format  (bool Metric, int IntDigits, int FractionDigits);
+        void Aperture(int Code, const char* Diameter, int Length);
+        void Begin   ();
+        void End     ();
+        void Select  (int Code);
+        void Linear  ();
+        void Circular(bool CCW);
+
+        inline void Flash(int X, int Y){
+            Writer.String(Prefix.data(), Prefix.length());
+            Writer.Decimal(X, FractionDigits); Writer.Char(',');
+            Writer.Decimal(Y, FractionDigits); Writer.Char('\n');
+        }
+
+        void Move         (int X, int Y);
+        void Draw         (int X, int Y);
+        void Arc          (int X, int Y, int I, int J);
+        void Circle       (int X, int Y, int R);
+        void StepRepeat   (int CountX, int CountY, int StepX, int StepY);
+        void EndStepRepeat();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,301 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Dedupe.h"
+//------------------------------------------------------------------------------
+
+static const size_t InitialSize = 0x1000; // Entries; a power of two
+//------------------------------------------------------------------------------
+
+// Rounds towards minus infinity, for the cells of negative coordinates
+static inline int FloorDivide(int a, int b){
+    int q = a / b;
+    if(a % b && a < 0) q--;
+    return q;
+}
+//------------------------------------------------------------------------------
+
+DEDUPE::DEDUPE(PLOTTER* Output, double Tolerance): FILTER(Output){
+    Millimetres = Tolerance;
+    Head        = 0;
+    Queued      = 0;
+    Code        = 0;
+    InBlock     = false;
+    Dropped     = false;
+    DroppedX    = 0;
+    DroppedY    = 0;
+
+    // The converter's default format, until it specifies one
+    SetUnits(true, 3);
+}
+//------------------------------------------------------------------------------
+
+// Converts the tolerance to file units, and starts a new index, as earlier
+// coordinates cannot be compared with later ones
+void DEDUPE::SetUnits(bool Metric, int FractionDigits){
+    double Scale = pow(10.0, FractionDigits);
+    if(!Metric) Scale /= 25.4;
+
+    Tolerance = (int)round(Millimetres * Scale);
+    Cell      = Tolerance > 0 ? 2*Tolerance : 1;
+
+    ENTRY Empty;
+    Empty.Code = INT_MIN;
+    Table.assign(InitialSize, Empty);
+    Count = 0;
+}
+//------------------------------------------------------------------------------
+
+size_t DEDUPE::Hash(int Code, int CellX, int CellY) const{
+    uint64_t h = (uint32_t)CellX * 0x9E3779B97F4A7C15ULL ^
+                 (uint32_t)CellY * 0xC2B2AE3D27D4EB4FULL ^
+                 (uint32_t)Code  * 0x165667B19E3779F9ULL;
+    return (size_t)(h ^ (h >> 32)) & (Table.size() - 1);
+}
+//------------------------------------------------------------------------------
+
+// Looks for an earlier flash of the same aperture in the cell.  The probe
+// sequence can include flashes of other cells, but a flash that is close
+// enough is a duplicate regardless.
+bool DEDUPE::Find(const FLASH& Flash, int CellX, int CellY) const{
+    size_t Mask = Table.size() - 1;
+    size_t n    = Hash(Flash.Code, CellX, CellY);
+
+    for(; Table[n].Code != INT_MIN; n = (n+1) & Mask){
+        const ENTRY& Entry = Table[n];
+        if(Entry.Code != Flash.Code) continue;
+
+        double dX = (double)Entry.X - Flash.X;
+        double dY = (double)Entry.Y - Flash.Y;
+        if(dX*dX + dY*dY <= (double)Tolerance * Tolerance) return true;
+    }
+    return false;
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Insert(const ENTRY& Entry, int CellX, int CellY){
+    size_t Mask = Table.size() - 1;
+    size_t n    = Hash(Entry.Code, CellX, CellY);
+
+    while(Table[n].Code != INT_MIN) n = (n+1) & Mask;
+    Table[n] = Entry;
+
+    // Keep the load factor below one half
+    if(++Count * 2 > Table.size()) Grow();
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Grow(){
+    std::vector<ENTRY> Old;
+    Old.swap(Table);
+
+    ENTRY Empty;
+    Empty.Code = INT_MIN;
+    Table.assign(2 * Old.size(), Empty);
+    Count = 0;
+
+    for(size_t n = 0; n < Old.size(); n++){
+        const ENTRY& Entry = Old[n];
+        if(Entry.Code == INT_MIN) continue;
+        Insert(Entry, FloorDivide(Entry.X, Cell), FloorDivide(Entry.Y, Cell));
+    }
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Process(const FLASH& Flash){
+    int CellX = FloorDivide(Flash.X, Cell);
+    int CellY = FloorDivide(Flash.Y, Cell);
+
+    bool Found;
+    if(Tolerance > 0){
+        // The square of one tolerance around the flash spans two cells in
+        // each direction at most
+        int Left   = FloorDivide(Flash.X - Tolerance, Cell);
+        int Bottom = FloorDivide(Flash.Y - Tolerance, Cell);
+
+        Found = Find(Flash, Left,   Bottom  ) || Find(Flash, Left+1, Bottom  ) ||
+                Find(Flash, Left,   Bottom+1) || Find(Flash, Left+1, Bottom+1);
+    }else{
+        Found = Find(Flash, CellX, CellY);
+    }
+
+    if(Found){
+        Removed[Flash.Code]++;
+        Dropped  = true;
+        DroppedX = Flash.X;
+        DroppedY = Flash.Y;
+        return;
+    }
+
+    ENTRY Entry;
+    Entry.Code = Flash.Code;
+    Entry.X    = Flash.X;
+    Entry.Y    = Flash.Y;
+    Insert(Entry, CellX, CellY);
+
+    Dropped = false;
+    Output->Flash(Flash.X, Flash.Y);
+}
+//------------------------------------------------------------------------------
+
+// Passes the queued flashes on
+void DEDUPE::Drain(){
+    while(Queued){
+        Process(Queue[Head]);
+        Head = (Head+1) & (Lookahead-1);
+        Queued--;
+    }
+}
+//------------------------------------------------------------------------------
+
+// Draws and arcs start at the current point, which might be a dropped flash
+void DEDUPE::Restore(){
+    if(Dropped){
+        Output->Move(DroppedX, DroppedY);
+        Dropped = false;
+    }
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Format(bool Metric, int IntDigits, int FractionDigits){
+    Drain();
+    SetUnits(Metric, FractionDigits);
+    Output->Format(Metric, IntDigits, FractionDigits);
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Aperture(int Code, const char* Diameter, int Length){
+    Drain();
+    Output->Aperture(Code, Diameter, Length);
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Begin(){
+    Drain();
+    Output->Begin();
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::End(){
+    Drain();
+    Output->End();
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Select(int Code){
+    Drain();
+    this->Code = Code;
+    Output->Select(Code);
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Linear(){
+    Drain();
+    Output->Linear();
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Circular(bool CCW){
+    Drain();
+    Output->Circular(CCW);
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Flash(int X, int Y){
+    if(InBlock){
+        Output->Flash(X, Y);
+        return;
+    }
+
+    if(Queued == Lookahead){
+        Process(Queue[Head]);
+        Head = (Head+1) & (Lookahead-1);
+        Queued--;
+    }
+
+    FLASH& Flash = Queue[(Head + Queued++) & (Lookahead-1)];
+    Flash.X    = X;
+    Flash.Y    = Y;
+    Flash.Code = Code;
+
+    // Written out here, as the compiler drops prefetches in a helper
+    // function that it deems free of side effects
+    #ifdef __GNUC__
+        if(Tolerance > 0){
+            int Left   = FloorDivide(X - Tolerance, Cell);
+            int Bottom = FloorDivide(Y - Tolerance, Cell);
+            __builtin_prefetch(&Table[Hash(Code, Left,   Bottom  )]);
+            __builtin_prefetch(&Table[Hash(Code, Left+1, Bottom  )]);
+            __builtin_prefetch(&Table[Hash(Code, Left,   Bottom+1)]);
+            __builtin_prefetch(&Table[Hash(Code, Left+1, Bottom+1)]);
+        }else{
+            __builtin_prefetch(&Table[Hash(Code, X, Y)]);
+        }
+    #endif
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Move(int X, int Y){
+    Drain();
+    Dropped = false;
+    Output->Move(X, Y);
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Draw(int X, int Y){
+    Drain();
+    Restore();
+    Output->Draw(X, Y);
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Arc(int X, int Y, int I, int J){
+    Drain();
+    Restore();
+    Output->Arc(X, Y, I, J);
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::Circle(int X, int Y, int R){
+    Drain();
+    Dropped = false;
+    Output->Circle(X, Y, R);
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::StepRepeat(int CountX, int CountY, int StepX, int StepY){
+    Drain();
+    Dropped = false;
+    InBlock = true;
+    Output->StepRepeat(CountX, CountY, StepX, StepY);
+}
+//------------------------------------------------------------------------------
+
+void DEDUPE::EndStepRepeat(){
+    InBlock = false;
+    Output->EndStepRepeat();
+}
+//------------------------------------------------------------------------------
+
+bool DEDUPE::Flush(){
+    Drain();
+    return Output->Flush();
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,111 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Dedupe_h
+#define Dedupe_h
+//------------------------------------------------------------------------------
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+#include "Filter.h"
+//------------------------------------------------------------------------------
+
+// Drops flashes that repeat an earlier flash of the same aperture within a
+// tolerance, such as the stacked hits of merged CAM layers.  Earlier flashes
+// are indexed in a hash table of grid cells two tolerances wide, so that each
+// flash only has to look in the four cells around it, in expected constant
+// time.  Flashes inside step-and-repeat blocks are passed on unchanged.
+//
+// The table is much larger than the cache, so flashes are held back in a
+// short queue while their table entries are prefetched.  Any other operation
+// first passes the queued flashes on.
+class DEDUPE: public FILTER{
+    private:
+        struct ENTRY{
+            int Code; // INT_MIN when empty
+            int X, Y;
+        };
+
+        struct FLASH{
+            int X, Y;
+            int Code;
+        };
+
+        static const int Lookahead = 16; // A power of two
+
+        double Millimetres; // Tolerance
+        int    Tolerance;   // In file units
+        int    Cell;        // Grid cell size in file units
+
+        std::vector<ENTRY> Table;
+        size_t             Count;
+
+        FLASH Queue[Lookahead];
+        int   Head, Queued;
+
+        int  Code;
+        bool InBlock;
+
+        // The current point after a dropped flash, which the output does not
+        // know about
+        bool Dropped;
+        int  DroppedX, DroppedY;
+
+        void   SetUnits(bool Metric, int FractionDigits);
+        void   Grow    ();
+        size_t Hash    (int Code, int CellX, int CellY) const;
+        bool   Find    (const FLASH& Flash, int CellX, int CellY) const;
+        void   Insert  (const ENTRY& Entry, int CellX, int CellY);
+        void   Process (const FLASH& Flash);
+        void   Drain   ();
+        void   Restore ();
+
+    public:
+        // Number of flashes dropped, per aperture code
+        std::map<int, long long> Removed;
+
+        // The tolerance is in mm; zero only drops exact repeats
+        DEDUPE(PLOTTER* Output, double Tolerance = 0);
+
+        void Format       (bool Metric, int IntDigits, int FractionDigits);
+        void Aperture     (int Code, const char* Diameter, int Length);
+        void Begin        ();
+        void End          ();
+        void Select       (int Code);
+        void Linear       ();
+        void Circular     (bool CCW);
+        void Flash        (int X, int Y);
+        void Move         (int X, int Y);
+        void Draw         (int X, int Y);
+        void Arc          (int X, int Y, int I, int J);
+        void Circle       (int X, int Y, int R);
+        void StepRepeat   (int CountX, int CountY, int StepX, int StepY);
+        void EndStepRepeat();
+        bool Flush        ();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,246 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Dxf.h"
+//------------------------------------------------------------------------------
+
+DXF_WRITER::DXF_WRITER(size_t BufferSize): Writer(BufferSize){
+    Open(0);
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::Open(SINK* Sink){
+    Writer.Open(Sink);
+
+    Metric         = true;
+    FractionDigits = 3;
+    Started        = false;
+    Layer          = "0";
+    Width          = "0";
+    Radius         = "0";
+    CCW            = false;
+    X = Y          = 0;
+    InPolyline     = false;
+    VertexX        = VertexY = 0;
+
+    Apertures.clear();
+}
+//------------------------------------------------------------------------------
+
+// The header, with the units, and the start of the entities
+void DXF_WRITER::Start(){
+    if(Started) return;
+
+    Writer.String("0\nSECTION\n2\nHEADER\n"
+                  "9\n$ACADVER\n1\nAC1009\n"
+                  "9\n$INSUNITS\n70\n");
+    Writer.String(Metric ? "4\n" : "1\n");
+    Writer.String("0\nENDSEC\n"
+                  "0\nSECTION\n2\nENTITIES\n");
+    Started = true;
+}
+//------------------------------------------------------------------------------
+
+bool DXF_WRITER::Close(){
+    Start();
+    EndPolyline();
+    Writer.String("0\nENDSEC\n0\nEOF\n");
+    return Writer.Flush();
+}
+//------------------------------------------------------------------------------
+
+bool DXF_WRITER::Flush(){
+    return Writer.Flush();
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::Format(bool Metric, int IntDigits, int FractionDigits){
+    this->Metric         = Metric;
+    this->FractionDigits = FractionDigits;
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::Aperture(int Code, const char* Diameter, int Length){
+    std::string Value(Diameter, Length);
+    Apertures[Code] = atof(Value.c_str());
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::Begin(){
+    Start();
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::End(){
+    EndPolyline();
+}
+//------------------------------------------------------------------------------
+
+// The width is the default of every vertex
+void DXF_WRITER::StartPolyline(bool Closed){
+    Start();
+
+    Writer.String("0\nPOLYLINE\n8\n");
+    Writer.String(Layer.data(), Layer.length());
+    Writer.String("\n66\n1\n10\n0\n20\n0\n30\n0\n");
+    if(Closed) Writer.String("70\n1\n");
+    Writer.String("40\n"); Writer.String(Width.data(), Width.length());
+    Writer.String("\n41\n"); Writer.String(Width.data(), Width.length());
+    Writer.Char('\n');
+
+    InPolyline = true;
+}
+//------------------------------------------------------------------------------
+
+// The bulge is the tangent of a quarter of the arc angle to the next vertex,
+// negative for clockwise arcs
+void DXF_WRITER::Vertex(int X, int Y, double Bulge){
+    Writer.String("0\nVERTEX\n8\n");
+    Writer.String(Layer.data(), Layer.length());
+    Writer.Char('\n');
+    Coordinates(X, Y);
+    if(Bulge != 0){
+        Writer.String("42\n"); Writer.Real(Bulge); Writer.Char('\n');
+    }
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::EndSequence(){
+    Writer.String("0\nSEQEND\n8\n");
+    Writer.String(Layer.data(), Layer.length());
+    Writer.Char('\n');
+
+    InPolyline = false;
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::EndPolyline(){
+    if(!InPolyline) return;
+
+    Vertex(VertexX, VertexY, 0);
+    EndSequence();
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::Select(int Code){
+    EndPolyline();
+
+    auto   Found    = Apertures.find(Code);
+    double Diameter = Found == Apertures.end() ? 0 : Found->second;
+
+    char Buffer[32];
+    snprintf(Buffer, sizeof(Buffer), "T%02d", Code - 10);
+    Layer = Buffer;
+    snprintf(Buffer, sizeof(Buffer), "%.10g", Diameter);
+    Width = Buffer;
+    snprintf(Buffer, sizeof(Buffer), "%.10g", Diameter / 2);
+    Radius = Buffer;
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::Linear(){}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::Circular(bool CCW){
+    this->CCW = CCW;
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::Flash(int X, int Y){
+    EndPolyline();
+    Start();
+
+    Writer.String("0\nCIRCLE\n8\n");
+    Writer.String(Layer.data(), Layer.length());
+    Writer.Char('\n');
+    Coordinates(X, Y);
+    Writer.String("40\n"); Writer.String(Radius.data(), Radius.length());
+    Writer.Char('\n');
+
+    this->X = X;
+    this->Y = Y;
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::Move(int X, int Y){
+    EndPolyline();
+
+    this->X = X;
+    this->Y = Y;
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::Draw(int X, int Y){
+    if(InPolyline){
+        Vertex(VertexX, VertexY, 0);
+    }else{
+        StartPolyline(false);
+        Vertex(this->X, this->Y, 0);
+    }
+    VertexX = this->X = X;
+    VertexY = this->Y = Y;
+}
+//------------------------------------------------------------------------------
+
+// A bulge cannot describe a full circle, so that is written in two halves
+void DXF_WRITER::Arc(int X, int Y, int I, int J){
+    if(!InPolyline){
+        StartPolyline(false);
+        VertexX = this->X;
+        VertexY = this->Y;
+    }
+
+    double CentreX = (double)this->X + I;
+    double CentreY = (double)this->Y + J;
+
+    double From = atan2(this->Y - CentreY, this->X - CentreX);
+    double To   = atan2(      Y - CentreY,       X - CentreX);
+
+    double Sweep = CCW ? To - From : From - To;
+    if(Sweep < 0) Sweep += 2*M_PI;
+
+    double Sign = CCW ? 1 : -1;
+    if(X == this->X && Y == this->Y){
+        Vertex(VertexX, VertexY, Sign);
+        Vertex(this->X + 2*I, this->Y + 2*J, Sign);
+    }else{
+        Vertex(VertexX, VertexY, Sign * tan(Sweep / 4));
+    }
+    VertexX = this->X = X;
+    VertexY = this->Y = Y;
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::Circle(int X, int Y, int R){
+    EndPolyline();
+
+    StartPolyline(true);
+    Vertex(X + R, Y, 1);
+    Vertex(X - R, Y, 1);
+    EndSequence();
+
+    this->X = X;
+    this->Y = Y;
+}
+//------------------------------------------------------------------------------
+
+void DXF_WRITER::StepRepeat(int CountX, int CountY, int StepX, int StepY){}
+void DXF_WRITER::EndStepRepeat(){}
+//------------------------------------------------------------------------------
@@ -0,0 +1,101 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Dxf_h
+#define Dxf_h
+//------------------------------------------------------------------------------
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <map>
+#include <string>
+
+#include "Plotter.h"
+#include "Writer.h"
+//------------------------------------------------------------------------------
+
+// Formats the output as an ASCII DXF (R12) drawing in mm or inches, with one
+// layer per tool, "T<Tool>".  Holes are circles of the tool diameter, and
+// routes are polylines with the tool width, where arcs are vertex bulges.
+//
+// Close ends the drawing.  Step-and-repeat blocks are not supported, and
+// must be unrolled first (see UNROLL).
+class DXF_WRITER: public PLOTTER{
+    private:
+        WRITER Writer;
+
+        bool Metric;
+        int  FractionDigits;
+        bool Started; // The header is written
+
+        std::map<int, double> Apertures; // Diameters in mm or inches
+
+        // Of the selected tool
+        std::string Layer;
+        std::string Width;
+        std::string Radius;
+
+        bool CCW;
+        int  X, Y; // Current point
+
+        // The last vertex of the polyline being written is only written with
+        // the next segment, which sets its bulge
+        bool InPolyline;
+        int  VertexX, VertexY;
+
+        void Start         ();
+        void StartPolyline (bool Closed);
+        void Vertex        (int X, int Y, double Bulge);
+        void EndSequence   ();
+        void EndPolyline   ();
+
+        inline void Coordinates(int X, int Y){
+            Writer.String("10\n"); Writer.Decimal(X, FractionDigits);
+            Writer.String("\n20\n"); Writer.Decimal(Y, FractionDigits);
+            Writer.Char('\n');
+        }
+
+    public:
+        DXF_WRITER(size_t BufferSize = 0x40000);
+
+        void Open (SINK* Sink);
+        bool Close(); // Ends the drawing and returns false on error
+        bool Flush();
+
+        void Format       (bool Metric, int IntDigits, int FractionDigits);
+        void Aperture     (int Code, const char* Diameter, int Length);
+        void Begin        ();
+        void End          ();
+        void Select       (int Code);
+        void Linear       ();
+        void Circular     (bool CCW);
+        void Flash        (int X, int Y);
+        void Move         (int X, int Y);
+        void Draw         (int X, int Y);
+        void Arc          (int X, int Y, int I, int J);
+        void Circle       (int X, int Y, int R);
+        void StepRepeat   (int CountX, int CountY, int StepX, int StepY);
+        void EndStepRepeat();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
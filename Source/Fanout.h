@@ -0,0 +1,80 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Fanout_h
+#define Fanout_h
+//------------------------------------------------------------------------------
+
+#include <vector>
+
+#include "Plotter.h"
+//------------------------------------------------------------------------------
+
+// Passes every operation on to all of its outputs, in the order in which they
+// were added, so that one conversion can write several formats at once.
+// Every output formats and buffers its own stream.
+class FANOUT: public PLOTTER{
+    private:
+        std::vector<PLOTTER*> Outputs;
+
+    public:
+        void Add(PLOTTER* Output){ Outputs.push_back(Output); }
+
+        void Format(bool Metric, int IntDigits, int FractionDigits){
+            for(auto Output: Outputs) Output->Format(Metric, IntDigits, FractionDigits);
+        }
+        void Aperture(int Code, const char* Diameter, int Length){
+            for(auto Output: Outputs) Output->Aperture(Code, Diameter, Length);
+        }
+        void Begin   ()            { for(auto Output: Outputs) Output->Begin   ();     }
+        void End     ()            { for(auto Output: Outputs) Output->End     ();     }
+        void Select  (int Code)    { for(auto Output: Outputs) Output->Select  (Code); }
+        void Linear  ()            { for(auto Output: Outputs) Output->Linear  ();     }
+        void Circular(bool CCW)    { for(auto Output: Outputs) Output->Circular(CCW);  }
+        void Flash   (int X, int Y){ for(auto Output: Outputs) Output->Flash   (X, Y); }
+        void Move    (int X, int Y){ for(auto Output: Outputs) Output->Move    (X, Y); }
+        void Draw    (int X, int Y){ for(auto Output: Outputs) Output->Draw    (X, Y); }
+
+        void Arc(int X, int Y, int I, int J){
+            for(auto Output: Outputs) Output->Arc(X, Y, I, J);
+        }
+        void Circle(int X, int Y, int R){
+            for(auto Output: Outputs) Output->Circle(X, Y, R);
+        }
+        void StepRepeat(int CountX, int CountY, int StepX, int StepY){
+            for(auto Output: Outputs) Output->StepRepeat(CountX, CountY, StepX, StepY);
+        }
+        void EndStepRepeat(){
+            for(auto Output: Outputs) Output->EndStepRepeat();
+        }
+
+        // Flushes all the outputs, even after one failed
+        bool Flush(){
+            bool Result = true;
+            for(auto Output: Outputs){
+                if(!Output->Flush()) Result = false;
+            }
+            return Result;
+        }
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,70 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Filter_h
+#define Filter_h
+//------------------------------------------------------------------------------
+
+#include "Plotter.h"
+//------------------------------------------------------------------------------
+
+// A plotter that passes everything on to another plotter.  Filters derive
+// from this and override the operations that they change.
+class FILTER: public PLOTTER{
+    protected:
+        PLOTTER* Output;
+
+    public:
+        FILTER(PLOTTER* Output){ this->Output = Output; }
+
+        void Format(bool Metric, int IntDigits, int FractionDigits){
+            Output->Format(Metric, IntDigits, FractionDigits);
+        }
+        void Aperture(int Code, const char* Diameter, int Length){
+            Output->Aperture(Code, Diameter, Length);
+        }
+        void Begin   ()            { Output->Begin   ();     }
+        void End     ()            { Output->End     ();     }
+        void Select  (int Code)    { Output->Select  (Code); }
+        void Linear  ()            { Output->Linear  ();     }
+        void Circular(bool CCW)    { Output->Circular(CCW);  }
+        void Flash   (int X, int Y){ Output->Flash   (X, Y); }
+        void Move    (int X, int Y){ Output->Move    (X, Y); }
+        void Draw    (int X, int Y){ Output->Draw    (X, Y); }
+
+        void Arc(int X, int Y, int I, int J){
+            Output->Arc(X, Y, I, J);
+        }
+        void Circle(int X, int Y, int R){
+            Output->Circle(X, Y, R);
+        }
+        void StepRepeat(int CountX, int CountY, int StepX, int StepY){
+            Output->StepRepeat(CountX, CountY, StepX, StepY);
+        }
+        void EndStepRepeat(){
+            Output->EndStepRepeat();
+        }
+
+        bool Flush(){ return Output->Flush(); }
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,125 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Gerber.h"
+//------------------------------------------------------------------------------
+
+GERBER_WRITER::GERBER_WRITER(size_t BufferSize): Writer(BufferSize){
+    LastX = LastY = 0;
+    FractionDigits = 0;
+}
+//------------------------------------------------------------------------------
+
+void GERBER_WRITER::Open(SINK* Sink){
+    Writer.Open(Sink);
+    LastX = LastY = 0;
+    FractionDigits = 0;
+}
+//------------------------------------------------------------------------------
+
+bool GERBER_WRITER::Flush(){
+    return Writer.Flush();
+}
+//------------------------------------------------------------------------------
+
+void GERBER_WRITER::Format(bool Metric, int IntDigits, int FractionDigits){
+    this->FractionDigits = FractionDigits;
+
+    Writer.String("%FSLAX");
+    Writer.Int(IntDigits); Writer.Int(FractionDigits);
+    Writer.Char('Y');
+    Writer.Int(IntDigits); Writer.Int(FractionDigits);
+    Writer.String(Metric ? "*MOMM*%\n" : "*MOIN*%\n");
+}
+//------------------------------------------------------------------------------
+
+void GERBER_WRITER::Aperture(int Code, const char* Diameter, int Length){
+    Writer.String("%ADD");
+    Writer.Int2(Code);
+    Writer.String("C,");
+    Writer.String(Diameter, Length);
+    Writer.String("*%\n");
+}
+//------------------------------------------------------------------------------
+
+void GERBER_WRITER::Begin(){
+    Writer.String("%LPD*%\nG01*\n");
+}
+//------------------------------------------------------------------------------
+
+void GERBER_WRITER::End(){
+    Writer.String("M02*\n");
+}
+//------------------------------------------------------------------------------
+
+void GERBER_WRITER::Linear(){
+    Writer.String("G01*\n");
+}
+//------------------------------------------------------------------------------
+
+void GERBER_WRITER::Circular(bool CCW){
+    Writer.String(CCW ? "G03*\nG75*\n" : "G02*\nG75*\n");
+}
+//------------------------------------------------------------------------------
+
+void GERBER_WRITER::Arc(int X, int Y, int I, int J){
+    Writer.Char('X'); Writer.Int(X);
+    Writer.Char('Y'); Writer.Int(Y);
+    Writer.Char('I'); Writer.Int(I);
+    Writer.Char('J'); Writer.Int(J);
+    Writer.String("D01*\n");
+    LastX = X;
+    LastY = Y;
+}
+//------------------------------------------------------------------------------
+
+void GERBER_WRITER::Circle(int X, int Y, int R){
+    Writer.Char('X'); Writer.Int(X+R);
+    Writer.Char('Y'); Writer.Int(Y);
+    Writer.String("D02*\nI");
+    Writer.Int(-R);
+    Writer.String("J0D01*\nX");
+    Writer.Int(X);
+    Writer.Char('Y'); Writer.Int(Y);
+    Writer.String("D02*\n");
+    LastX = X;
+    LastY = Y;
+}
+//------------------------------------------------------------------------------
+
+void GERBER_WRITER::StepRepeat(int CountX, int CountY, int StepX, int StepY){
+    Writer.String("%SRX"); Writer.Int(CountX);
+    Writer.Char  ('Y'   ); Writer.Int(CountY);
+    Writer.Char  ('I'   ); Writer.Decimal(StepX, FractionDigits);
+    Writer.Char  ('J'   ); Writer.Decimal(StepY, FractionDigits);
+    Writer.String("*%\n");
+
+    // The current point is undefined at the start of a block
+    Unknown();
+}
+//------------------------------------------------------------------------------
+
+void GERBER_WRITER::EndStepRepeat(){
+    Writer.String("%SR*%\n");
+
+    // ... and after the block
+    Unknown();
+}
+//------------------------------------------------------------------------------
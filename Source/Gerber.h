@@ -0,0 +1,89 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Gerber_h
+#define Gerber_h
+//------------------------------------------------------------------------------
+
+#include <limits.h>
+
+#include "Plotter.h"
+#include "Writer.h"
+//------------------------------------------------------------------------------
+
+// Formats the Gerber output.  Coordinates are only written when they differ
+// from the current point.
+class GERBER_WRITER: public PLOTTER{
+    private:
+        int LastX, LastY; // Current point of the Gerber output
+        int FractionDigits;
+
+        inline void Coordinate(int X, int Y){
+            if(LastX != X){ Writer.Char('X'); Writer.Int(X); }
+            if(LastY != Y){ Writer.Char('Y'); Writer.Int(Y); }
+            LastX = X;
+            LastY = Y;
+        }
+
+    public:
+        WRITER Writer;
+
+        GERBER_WRITER(size_t BufferSize = 0x40000);
+
+        void Open (SINK* Sink);
+        bool Flush();
+
+        void Format  (bool Metric, int IntDigits, int FractionDigits);
+        void Aperture(int Code, const char* Diameter, int Length);
+        void Begin   ();
+        void End     ();
+
+        inline void Select(int Code){
+            Writer.Char('D'); Writer.Int2(Code); Writer.String("*\n", 2);
+        }
+
+        void Linear  ();
+        void Circular(bool CCW);
+
+        inline void Flash(int X, int Y){
+            Coordinate(X, Y); Writer.String("D03*\n", 5);
+        }
+        inline void Move(int X, int Y){
+            Coordinate(X, Y); Writer.String("D02*\n", 5);
+        }
+        inline void Draw(int X, int Y){
+            Coordinate(X, Y); Writer.String("D01*\n", 5);
+        }
+
+        void Arc   (int X, int Y, int I, int J);
+        void Circle(int X, int Y, int R);
+
+        // Forces both coordinates of the next operation to be written
+        inline void Unknown(){
+            LastX = LastY = INT_MIN;
+        }
+
+        void StepRepeat   (int CountX, int CountY, int StepX, int StepY);
+        void EndStepRepeat();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,191 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Gzip.h"
+
+#include <new>
+//------------------------------------------------------------------------------
+
+static const size_t BlockSize = 0x10000;
+//------------------------------------------------------------------------------
+
+GZIP_SOURCE::GZIP_SOURCE(SOURCE* Input){
+    this->Input = Input;
+
+    memset(&Stream, 0, sizeof(Stream));
+    Buffer = new char[BlockSize];
+
+    Started    = false;
+    Compressed = false;
+    EndOfInput = false;
+    Failed     = false;
+}
+//------------------------------------------------------------------------------
+
+GZIP_SOURCE::~GZIP_SOURCE(){
+    if(Compressed) inflateEnd(&Stream);
+    delete[] Buffer;
+}
+//------------------------------------------------------------------------------
+
+bool GZIP_SOURCE::IsCompressed(const char* Data, size_t Length){
+    return Length >= 2 && (unsigned char)Data[0] == 0x1F &&
+                          (unsigned char)Data[1] == 0x8B;
+}
+//------------------------------------------------------------------------------
+
+// Refills the empty input buffer and returns false at the end of the input
+bool GZIP_SOURCE::Fill(){
+    if(EndOfInput) return false;
+
+    size_t Count = Input->Read(Buffer, BlockSize);
+    if(!Count){
+        EndOfInput = true;
+        return false;
+    }
+    Stream.next_in  = (Bytef*)Buffer;
+    Stream.avail_in = Count;
+    return true;
+}
+//------------------------------------------------------------------------------
+
+void GZIP_SOURCE::Start(){
+    Started = true;
+    if(!Fill()) return;
+
+    // The header is in the first block, unless the source returns very small
+    // blocks, which is not worth supporting
+    Compressed = IsCompressed(Buffer, Stream.avail_in);
+    if(Compressed && inflateInit2(&Stream, 15 + 32) != Z_OK){
+        throw std::bad_alloc();
+    }
+}
+//------------------------------------------------------------------------------
+
+bool GZIP_SOURCE::IsCompressed(){
+    if(!Started) Start();
+    return Compressed;
+}
+//------------------------------------------------------------------------------
+
+size_t GZIP_SOURCE::Read(char* Data, size_t Size){
+    if(!Started) Start();
+
+    if(!Compressed){
+        if(!Stream.avail_in && !Fill()) return 0;
+
+        size_t Count = Stream.avail_in < Size ? Stream.avail_in : Size;
+        memcpy(Data, Stream.next_in, Count);
+        Stream.next_in  += Count;
+        Stream.avail_in -= Count;
+        return Count;
+    }
+
+    if(Failed) return 0;
+
+    Stream.next_out  = (Bytef*)Data;
+    Stream.avail_out = Size;
+
+    while(Stream.avail_out == Size){
+        if(!Stream.avail_in && !Fill()){
+            // Truncated: the last member did not end
+            if(Stream.total_in) Failed = true;
+            break;
+        }
+        int Result = inflate(&Stream, Z_NO_FLUSH);
+
+        if(Result == Z_STREAM_END){
+            // Another member may follow
+            inflateReset(&Stream);
+            Stream.total_in = 0;
+
+        }else if(Result != Z_OK && Result != Z_BUF_ERROR){
+            Failed = true;
+            break;
+        }
+    }
+    return Size - Stream.avail_out;
+}
+//------------------------------------------------------------------------------
+
+GZIP_SINK::GZIP_SINK(SINK* Output, int Level){
+    this->Output = Output;
+
+    memset(&Stream, 0, sizeof(Stream));
+    if(deflateInit2(&Stream, Level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK){
+        throw std::bad_alloc();
+    }
+    Buffer = new char[BlockSize];
+    Closed = false;
+    Failed = false;
+}
+//------------------------------------------------------------------------------
+
+GZIP_SINK::~GZIP_SINK(){
+    deflateEnd(&Stream);
+    delete[] Buffer;
+}
+//------------------------------------------------------------------------------
+
+bool GZIP_SINK::Deflate(const char* Data, size_t Length, int Mode){
+    if(Closed || Failed) return false;
+
+    Stream.next_in  = (Bytef*)Data;
+    Stream.avail_in = Length;
+
+    do{
+        Stream.next_out  = (Bytef*)Buffer;
+        Stream.avail_out = BlockSize;
+
+        int Result = deflate(&Stream, Mode);
+        if(Result == Z_STREAM_ERROR){
+            Failed = true;
+            return false;
+        }
+        size_t Count = BlockSize - Stream.avail_out;
+        if(Count && !Output->Write(Buffer, Count)){
+            Failed = true;
+            return false;
+        }
+    }while(Stream.avail_in || !Stream.avail_out);
+
+    return true;
+}
+//------------------------------------------------------------------------------
+
+bool GZIP_SINK::Write(const char* Data, size_t Length){
+    return Deflate(Data, Length, Z_NO_FLUSH);
+}
+//------------------------------------------------------------------------------
+
+bool GZIP_SINK::Flush(){
+    if(Closed) return !Failed && Output->Flush();
+    return Deflate(0, 0, Z_SYNC_FLUSH) && Output->Flush();
+}
+//------------------------------------------------------------------------------
+
+bool GZIP_SINK::Close(){
+    if(Closed) return !Failed;
+
+    bool Result = Deflate(0, 0, Z_FINISH) && Output->Flush();
+    Closed = true;
+    return Result;
+}
+//------------------------------------------------------------------------------
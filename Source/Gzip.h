@@ -0,0 +1,85 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Gzip_h
+#define Gzip_h
+//------------------------------------------------------------------------------
+
+#include <zlib.h>
+
+#include "Stream.h"
+//------------------------------------------------------------------------------
+
+// Decompresses gzip (or zlib) data from another source, in fixed-size blocks
+// so that the memory use does not depend on the input size.  Concatenated
+// gzip members are read as one stream.  Input that does not start with a
+// gzip header is passed through unchanged.
+class GZIP_SOURCE: public SOURCE{
+    private:
+        SOURCE*   Input;
+        z_stream  Stream;
+        char*     Buffer;
+        bool      Started;
+        bool      Compressed;
+        bool      EndOfInput;
+
+        bool Fill ();
+        void Start();
+
+    public:
+        bool Failed; // The compressed data is corrupt or truncated
+
+        GZIP_SOURCE(SOURCE* Input);
+       ~GZIP_SOURCE();
+
+        size_t Read(char* Buffer, size_t Size);
+
+        // Whether the input is compressed, which reads the first block
+        bool IsCompressed();
+
+        // Whether the data starts with the gzip magic bytes
+        static bool IsCompressed(const char* Data, size_t Length);
+};
+//------------------------------------------------------------------------------
+
+// Compresses to gzip format and writes to another sink.  Flush passes on
+// everything written so far, and Close writes the gzip trailer.
+class GZIP_SINK: public SINK{
+    private:
+        SINK*    Output;
+        z_stream Stream;
+        char*    Buffer;
+        bool     Closed;
+        bool     Failed;
+
+        bool Deflate(const char* Data, size_t Length, int Mode);
+
+    public:
+        GZIP_SINK(SINK* Output, int Level = Z_DEFAULT_COMPRESSION);
+       ~GZIP_SINK();
+
+        bool Write(const char* Data, size_t Length);
+        bool Flush();
+        bool Close();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,145 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Incremental.h"
+//------------------------------------------------------------------------------
+
+INCREMENTAL::INCREMENTAL(){
+    Converted  = 0;
+    Checksum   = 0;
+    LineNumber = 0;
+    Dropped    = 0;
+    ResumedAt  = 0;
+
+    MaxRecorded = 64 << 20;
+}
+//------------------------------------------------------------------------------
+
+void INCREMENTAL::Reset(){
+    Converter.reset();
+    Body     .reset();
+    Dropped = 0;
+}
+//------------------------------------------------------------------------------
+
+bool INCREMENTAL::ConvertAll(const char* Data, size_t Length, PLOTTER* Output){
+    CONVERTER Whole;
+    Whole.Options = Options;
+
+    READER Reader;
+    Reader.Open(Data, Length);
+    bool Result = Whole.Convert(&Reader, Output);
+
+    ResumedAt   = 0;
+    Diagnostics = Whole.Diagnostics;
+    Statistics  = Whole.Statistics;
+    return Result;
+}
+//------------------------------------------------------------------------------
+
+bool INCREMENTAL::Convert(const char* Data, size_t Length, PLOTTER* Output){
+    if(Dropped && Length >= Dropped) return ConvertAll(Data, Length, Output);
+
+    STOPWATCH Watch;
+
+    // Only appended to if everything converted before is unchanged
+    if(Converter && Length >= Converted && Hash(Data, Converted) == Checksum){
+        ResumedAt = LineNumber;
+
+    }else{
+        Converter.reset(new CONVERTER);
+        Body     .reset(new BODY);
+        Converter->Options = Options;
+        Converter->Begin(Body.get());
+
+        Converted  = 0;
+        LineNumber = 0;
+        Dropped    = 0;
+        ResumedAt  = 0;
+    }
+
+    // The new complete lines
+    const char* Start = Data + Converted;
+    const char* Stop  = Start;
+    for(const char* p = Data + Length; p > Start; p--){
+        if(p[-1] == '\n'){
+            Stop = p;
+            break;
+        }
+    }
+
+    READER Reader;
+    LINE   Line;
+    Reader.Open(Start, Stop - Start);
+    while(Reader.ReadLine(Line)){
+        Converter->Convert(Line);
+        LineNumber++;
+
+        // Checked every few thousand lines, so that the recording stays
+        // close to the limit
+        if(!(LineNumber & 0xFFF) && Body->Length() > MaxRecorded){
+            Reset();
+            Dropped = Length;
+            return ConvertAll(Data, Length, Output);
+        }
+    }
+    Converted = Stop - Data;
+    Checksum  = Hash(Data, Converted);
+
+    // The incomplete line, if any, on a copy of the state
+    CONVERTER Tail;
+    BODY      TailBody;
+    Tail.Options = Options;
+    Tail.Begin(&TailBody);
+
+    CONVERTER::STATE State;
+    Converter->GetState(&State);
+    Tail.SetState(State, LineNumber, false);
+
+    Reader.Open(Stop, Data + Length - Stop);
+    while(Reader.ReadLine(Line)) Tail.Convert(Line);
+    bool Result = Tail.End() && !Converter->Error;
+
+    Diagnostics = Converter->Diagnostics;
+    Diagnostics.insert(Diagnostics.end(), Tail.Diagnostics.begin(), Tail.Diagnostics.end());
+
+    Statistics.Clear();
+    Statistics.Add(Converter->Statistics);
+    Statistics.Add(Tail.Statistics);
+    Watch.Split(Statistics.Parse);
+
+    Replay(Body  ->Data(), Body  ->Length(), Output);
+    Replay(TailBody.Data(), TailBody.Length(), Output);
+    if(Body->Ended || TailBody.Ended) Output->End();
+
+    if(!Output->Flush()){
+        DIAGNOSTIC Diagnostic;
+        Diagnostic.Level       = DIAGNOSTIC::Error;
+        Diagnostic.LineNumber  = 0;
+        Diagnostic.Unsupported = false;
+        Diagnostic.Message     = "Cannot write to the output";
+        Diagnostics.push_back(Diagnostic);
+        Result = false;
+    }
+    Watch.Split(Statistics.Emit);
+
+    return Result;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,97 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Incremental_h
+#define Incremental_h
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "Converter.h"
+#include "Model.h"
+#include "Record.h"
+//------------------------------------------------------------------------------
+
+// Converts a file repeatedly as it changes, keeping the converter and its
+// output between conversions.  When the new content only appends to the
+// content converted before, parsing resumes from the parser state at the end
+// of the last complete line, instead of starting over.  A trailing incomplete
+// line is converted separately every time, as it may still grow.
+//
+// Only the parsing is resumed.  The content converted before is still hashed
+// to check that it is unchanged, and the whole recording is replayed into the
+// output, which is written in full every time.
+//
+// The recording is dropped once it grows beyond MaxRecorded.  The file is
+// then converted in full, without recording, until it becomes shorter than
+// it was when the recording was dropped.
+class INCREMENTAL{
+    private:
+        // Records the operations, but holds the end back, so that more can
+        // be appended
+        class BODY: public RECORDER{
+            public:
+                bool Ended;
+
+                BODY(){ Ended = false; }
+                void End(){ Ended = true; }
+        };
+
+        std::unique_ptr<CONVERTER> Converter;
+        std::unique_ptr<BODY>      Body;
+
+        size_t   Converted;  // Bytes of complete lines
+        uint64_t Checksum;   // Of those bytes
+        int      LineNumber; // Of the last complete line
+        size_t   Dropped;    // Length when the recording was dropped, or 0
+
+        // Converts the whole content straight into the plotter
+        bool ConvertAll(const char* Data, size_t Length, PLOTTER* Output);
+
+    public:
+        CONVERTER::OPTIONS Options;
+
+        // Bytes of recorded operations kept between conversions
+        size_t MaxRecorded;
+
+        // The line after which the last conversion resumed, or 0 if it
+        // started over
+        int ResumedAt;
+
+        // Of the last conversion as a whole
+        std::vector<DIAGNOSTIC> Diagnostics;
+        STATISTICS              Statistics;
+
+        INCREMENTAL();
+
+        // Converts the whole content into the plotter and returns false on
+        // error
+        bool Convert(const char* Data, size_t Length, PLOTTER* Output);
+
+        // Starts over on the next conversion
+        void Reset();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
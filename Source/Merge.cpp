@@ -0,0 +1,303 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Merge.h"
+//------------------------------------------------------------------------------
+
+// Collects the format and apertures of a recording and ignores the rest
+class SCANNER: public PLOTTER{
+    public:
+        bool Formatted;
+        bool Metric;
+        int  IntDigits;
+        int  FractionDigits;
+
+        std::vector<MERGE::APERTURE>* Apertures;
+
+        SCANNER(std::vector<MERGE::APERTURE>* Apertures){
+            this->Apertures = Apertures;
+            Formatted       = false;
+            Metric          = false;
+            IntDigits       = 0;
+            FractionDigits  = 0;
+        }
+
+        void Format(bool Metric, int IntDigits, int FractionDigits){
+            Formatted            = true;
+            this->Metric         = Metric;
+            this->IntDigits      = IntDigits;
+            this->FractionDigits = FractionDigits;
+        }
+
+        void Aperture(int Code, const char* Diameter, int Length){
+            // The converter passes the character after the number on
+            while(Length > 0 && (Diameter[Length-1] < '0' || Diameter[Length-1] > '9')){
+                if(Diameter[Length-1] == '.') break;
+                Length--;
+            }
+            MERGE::APERTURE Aperture;
+            Aperture.Code = Code;
+            Aperture.Text.assign(Diameter, Length);
+            Aperture.Diameter = atof(Aperture.Text.c_str());
+            Apertures->push_back(Aperture);
+        }
+
+        void Begin        (){}
+        void End          (){}
+        void Select       (int){}
+        void Linear       (){}
+        void Circular     (bool){}
+        void Flash        (int, int){}
+        void Move         (int, int){}
+        void Draw         (int, int){}
+        void Arc          (int, int, int, int){}
+        void Circle       (int, int, int){}
+        void StepRepeat   (int, int, int, int){}
+        void EndStepRepeat(){}
+        bool Flush        (){ return true; }
+};
+//------------------------------------------------------------------------------
+
+// Passes the drawing of one input on, with the aperture codes of the
+// combined table and the coordinates scaled to the output format.  The
+// header and the end of the input are dropped.
+class REMAP: public FILTER{
+    private:
+        std::map<int, int>* Codes;
+        int*                NextCode;
+
+        double Factor;
+        bool   Identity;
+
+        inline int Scale(int Value) const{
+            return Identity ? Value : (int)llround(Value * Factor);
+        }
+
+    public:
+        bool CircularMode;
+
+        REMAP(PLOTTER* Output, std::map<int, int>* Codes, int* NextCode, double Factor):
+        FILTER(Output){
+            this->Codes    = Codes;
+            this->NextCode = NextCode;
+            this->Factor   = Factor;
+            Identity       = (Factor == 1);
+            CircularMode   = false;
+        }
+
+        void Format  (bool, int, int){}
+        void Aperture(int, const char*, int){}
+        void Begin   (){}
+        void End     (){}
+
+        void Select(int Code){
+            auto Found = Codes->find(Code);
+            if(Found == Codes->end()){
+                // Not defined in the input, but kept apart from the others
+                Found = Codes->insert(std::make_pair(Code, (*NextCode)++)).first;
+            }
+            Output->Select(Found->second);
+        }
+
+        void Linear(){
+            CircularMode = false;
+            Output->Linear();
+        }
+        void Circular(bool CCW){
+            CircularMode = true;
+            Output->Circular(CCW);
+        }
+
+        void Flash(int X, int Y){ Output->Flash(Scale(X), Scale(Y)); }
+        void Move (int X, int Y){ Output->Move (Scale(X), Scale(Y)); }
+        void Draw (int X, int Y){ Output->Draw (Scale(X), Scale(Y)); }
+
+        void Arc(int X, int Y, int I, int J){
+            Output->Arc(Scale(X), Scale(Y), Scale(I), Scale(J));
+        }
+        void Circle(int X, int Y, int R){
+            Output->Circle(Scale(X), Scale(Y), Scale(R));
+        }
+        void StepRepeat(int CountX, int CountY, int StepX, int StepY){
+            Output->StepRepeat(CountX, CountY, Scale(StepX), Scale(StepY));
+        }
+};
+//------------------------------------------------------------------------------
+
+MERGE::MERGE(){
+    Formatted      = false;
+    Metric         = false;
+    IntDigits      = 0;
+    FractionDigits = 0;
+    NextCode       = 10;
+}
+//------------------------------------------------------------------------------
+
+void MERGE::Add(const RECORDER* Recording){
+    INPUT Input;
+    Input.Recording      = Recording;
+    Input.Formatted      = false;
+    Input.Metric         = false;
+    Input.IntDigits      = 0;
+    Input.FractionDigits = 0;
+    Inputs.push_back(Input);
+}
+//------------------------------------------------------------------------------
+
+// The same units, in the finest format of the inputs, or mm when the units
+// differ.  An inch coordinate needs two more integer digits and one more
+// fraction digit in mm.
+void MERGE::SetFormat(){
+    bool Mixed = false;
+
+    for(size_t n = 0; n < Inputs.size(); n++){
+        const INPUT& Input = Inputs[n];
+        if(!Input.Formatted) continue;
+
+        if(!Formatted){
+            Formatted = true;
+            Metric    = Input.Metric;
+        }else if(Metric != Input.Metric){
+            Mixed = true;
+        }
+    }
+    if(Mixed) Metric = true;
+
+    for(size_t n = 0; n < Inputs.size(); n++){
+        const INPUT& Input = Inputs[n];
+        if(!Input.Formatted) continue;
+
+        int Int      = Input.IntDigits;
+        int Fraction = Input.FractionDigits;
+        if(Input.Metric != Metric){
+            Int      += 2;
+            Fraction += 1;
+        }
+        if(IntDigits      < Int     ) IntDigits      = Int;
+        if(FractionDigits < Fraction) FractionDigits = Fraction;
+    }
+    if(FractionDigits > 6) FractionDigits = 6;
+}
+//------------------------------------------------------------------------------
+
+// The factor from input units to output units.  Inputs without a format are
+// assumed to be in the output format.
+double MERGE::GetScale(const INPUT& Input) const{
+    if(!Input.Formatted) return 1;
+
+    double Scale = pow(10.0, FractionDigits - Input.FractionDigits);
+    if(Input.Metric != Metric) Scale *= 25.4;
+    return Scale;
+}
+//------------------------------------------------------------------------------
+
+// Reads the format and apertures of every input, then builds the combined
+// aperture table and the code map of every input
+void MERGE::Scan(){
+    for(size_t n = 0; n < Inputs.size(); n++){
+        INPUT&  Input = Inputs[n];
+        SCANNER Scanner(&Input.Apertures);
+
+        Replay(Input.Recording->Data(), Input.Recording->Length(), &Scanner);
+
+        Input.Formatted      = Scanner.Formatted;
+        Input.Metric         = Scanner.Metric;
+        Input.IntDigits      = Scanner.IntDigits;
+        Input.FractionDigits = Scanner.FractionDigits;
+    }
+    SetFormat();
+
+    // Diameters are compared to a millionth of the output unit
+    std::map<long long, APERTURE> Table;
+
+    for(size_t n = 0; n < Inputs.size(); n++){
+        INPUT& Input = Inputs[n];
+
+        bool Convert = Input.Formatted && Input.Metric != Metric;
+
+        for(size_t a = 0; a < Input.Apertures.size(); a++){
+            APERTURE Aperture = Input.Apertures[a];
+
+            if(Convert){
+                char Buffer[0x40];
+                Aperture.Diameter *= 25.4;
+                snprintf(Buffer, sizeof(Buffer), "%.6f", Aperture.Diameter);
+
+                int Length = strlen(Buffer);
+                while(Buffer[Length-1] == '0') Length--;
+                if   (Buffer[Length-1] == '.') Length--;
+                Aperture.Text.assign(Buffer, Length);
+            }
+            Table.insert(std::make_pair(llround(Aperture.Diameter * 1e6), Aperture));
+        }
+    }
+
+    // Number the table in order of size
+    Apertures.clear();
+    for(auto& Entry: Table){
+        APERTURE Aperture = Entry.second;
+        Aperture.Code = 10 + Apertures.size();
+        Apertures.push_back(Aperture);
+    }
+    NextCode = 10 + Apertures.size();
+
+    for(size_t n = 0; n < Inputs.size(); n++){
+        INPUT& Input = Inputs[n];
+
+        bool Convert = Input.Formatted && Input.Metric != Metric;
+
+        for(size_t a = 0; a < Input.Apertures.size(); a++){
+            const APERTURE& Aperture = Input.Apertures[a];
+
+            double Diameter = Aperture.Diameter;
+            if(Convert) Diameter *= 25.4;
+
+            int Index = std::distance(Table.begin(), Table.find(llround(Diameter * 1e6)));
+            Input.Codes[Aperture.Code] = Apertures[Index].Code;
+        }
+    }
+}
+//------------------------------------------------------------------------------
+
+void MERGE::Write(PLOTTER* Output){
+    Scan();
+
+    if(Formatted) Output->Format(Metric, IntDigits, FractionDigits);
+
+    for(size_t n = 0; n < Apertures.size(); n++){
+        const APERTURE& Aperture = Apertures[n];
+        Output->Aperture(Aperture.Code, Aperture.Text.data(), Aperture.Text.length());
+    }
+    Output->Begin();
+
+    // Every input expects linear interpolation at the start
+    bool CircularMode = false;
+
+    for(size_t n = 0; n < Inputs.size(); n++){
+        INPUT& Input = Inputs[n];
+        REMAP  Remap(Output, &Input.Codes, &NextCode, GetScale(Input));
+
+        if(CircularMode) Output->Linear();
+        Replay(Input.Recording->Data(), Input.Recording->Length(), &Remap);
+        CircularMode = Remap.CircularMode;
+    }
+    Output->End();
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,95 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Merge_h
+#define Merge_h
+//------------------------------------------------------------------------------
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Filter.h"
+#include "Record.h"
+//------------------------------------------------------------------------------
+
+// Combines the recorded conversions of several drill files (such as plated,
+// non-plated and routed) into one drawing.  The apertures of all the inputs
+// are combined into one table with one code per diameter, in order of
+// increasing size.  Inputs in different units or formats are scaled to a
+// common format: that of the inputs if they agree, otherwise the finer of
+// their formats, in mm if the units differ.
+class MERGE{
+    public:
+        struct APERTURE{
+            int         Code;
+            double      Diameter;
+            std::string Text;
+        };
+
+    private:
+        struct INPUT{
+            const RECORDER* Recording;
+
+            // As defined in the input
+            std::vector<APERTURE> Apertures;
+
+            bool Formatted;
+            bool Metric;
+            int  IntDigits;
+            int  FractionDigits;
+
+            std::map<int, int> Codes; // From the input to the output
+        };
+
+        std::vector<INPUT> Inputs;
+
+        bool Formatted; // Whether any input specified the format
+        bool Metric;
+        int  IntDigits;
+        int  FractionDigits;
+
+        int  NextCode; // For apertures selected but never defined
+
+        void   Scan     ();
+        void   SetFormat();
+        double GetScale (const INPUT& Input) const;
+
+    public:
+        // The combined table, in output units and in order of code
+        std::vector<APERTURE> Apertures;
+
+        MERGE();
+
+        // The recording must remain valid until Write is called
+        void   Add   (const RECORDER* Recording);
+        size_t Count () const{ return Inputs.size(); }
+
+        // Passes the combined drawing on, in one pass over the inputs
+        void Write(PLOTTER* Output);
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,271 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Model.h"
+//------------------------------------------------------------------------------
+
+static const uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+//------------------------------------------------------------------------------
+
+static inline uint64_t Rotate(uint64_t Value, int Bits){
+    return (Value << Bits) | (Value >> (64 - Bits));
+}
+//------------------------------------------------------------------------------
+
+static inline uint64_t Round(uint64_t Lane, uint64_t Word){
+    return Rotate(Lane + Word*Prime2, 31) * Prime1;
+}
+//------------------------------------------------------------------------------
+
+// Four independent lanes of 8 bytes each, so that long inputs are hashed at
+// close to memory bandwidth
+uint64_t Hash(const void* Data, size_t Length, uint64_t Seed){
+    const char* Bytes = (const char*)Data;
+    const char* End   = Bytes + Length;
+    uint64_t    Word;
+
+    uint64_t Lane[4] = {Seed + Prime1 + Prime2, Seed + Prime2, Seed, Seed - Prime1};
+
+    for(; End - Bytes >= 32; Bytes += 32){
+        for(int n = 0; n < 4; n++){
+            memcpy(&Word, Bytes + 8*n, 8);
+            Lane[n] = Round(Lane[n], Word);
+        }
+    }
+
+    uint64_t Result = Rotate(Lane[0], 1) + Rotate(Lane[1], 7) +
+                      Rotate(Lane[2], 12) + Rotate(Lane[3], 18);
+    Result += Length;
+
+    for(; End - Bytes >= 8; Bytes += 8){
+        memcpy(&Word, Bytes, 8);
+        Result = Rotate(Result ^ Round(0, Word), 27) * Prime1;
+    }
+    for(; Bytes < End; Bytes++){
+        Result = Rotate(Result ^ ((unsigned char)*Bytes * Prime2), 11) * Prime1;
+    }
+
+    Result ^= Result >> 33; Result *= Prime2;
+    Result ^= Result >> 29; Result *= Prime1;
+    Result ^= Result >> 32;
+    return Result;
+}
+//------------------------------------------------------------------------------
+
+MODEL::MODEL(){
+    Key              = 0;
+    Error            = false;
+    RecognisedFormat = false;
+}
+//------------------------------------------------------------------------------
+
+void MODEL::SetResult(const CONVERTER& Converter){
+    Error            = Converter.Error;
+    RecognisedFormat = Converter.RecognisedFormat;
+    Diagnostics      = Converter.Diagnostics;
+
+    Statistics.Clear();
+    Statistics.Add(Converter.Statistics);
+}
+//------------------------------------------------------------------------------
+
+static void PutInt(std::string& Buffer, uint32_t Value){
+    Buffer.append((const char*)&Value, sizeof(Value));
+}
+//------------------------------------------------------------------------------
+
+static uint32_t GetInt(const char*& Data){
+    uint32_t Value;
+    memcpy(&Value, Data, sizeof(Value));
+    Data += sizeof(Value);
+    return Value;
+}
+//------------------------------------------------------------------------------
+
+static void PutCount(std::string& Buffer, long long Value){
+    Buffer.append((const char*)&Value, sizeof(Value));
+}
+//------------------------------------------------------------------------------
+
+static long long GetCount(const char*& Data){
+    long long Value;
+    memcpy(&Value, Data, sizeof(Value));
+    Data += sizeof(Value);
+    return Value;
+}
+//------------------------------------------------------------------------------
+
+static void PutCodes(std::string& Buffer, const std::map<std::string, long long>& Codes){
+    PutInt(Buffer, Codes.size());
+    for(auto& Code: Codes){
+        PutCount(Buffer, Code.second);
+        PutInt  (Buffer, Code.first.length());
+        Buffer += Code.first;
+    }
+}
+//------------------------------------------------------------------------------
+
+// Returns false if the codes run past the end
+static bool GetCodes(
+    const char*&                      Data,
+    const char*                       End,
+    std::map<std::string, long long>& Codes
+){
+    if(End - Data < 4) return false;
+    uint32_t Count = GetInt(Data);
+
+    for(uint32_t n = 0; n < Count; n++){
+        if(End - Data < 12) return false;
+        long long Value  = GetCount(Data);
+        uint32_t  Length = GetInt  (Data);
+        if((uint64_t)(End - Data) < Length) return false;
+
+        Codes[std::string(Data, Length)] = Value;
+        Data += Length;
+    }
+    return true;
+}
+//------------------------------------------------------------------------------
+
+bool MODEL::Save(const char* Filename) const{
+    std::string Buffer;
+    for(size_t n = 0; n < Diagnostics.size(); n++){
+        const DIAGNOSTIC& Diagnostic = Diagnostics[n];
+        PutInt(Buffer, Diagnostic.Level);
+        PutInt(Buffer, Diagnostic.LineNumber);
+        PutInt(Buffer, Diagnostic.Unsupported);
+        PutInt(Buffer, Diagnostic.Message.length());
+        Buffer += Diagnostic.Message;
+    }
+
+    PutInt(Buffer, Statistics.Tools.size());
+    for(auto& Tool: Statistics.Tools){
+        PutInt  (Buffer, Tool.first);
+        PutCount(Buffer, Tool.second.Hits);
+        PutCount(Buffer, Tool.second.Slots);
+        PutCount(Buffer, Tool.second.Routes);
+        PutCount(Buffer, Tool.second.Arcs);
+        PutCount(Buffer, Tool.second.Repeats);
+    }
+    PutCodes(Buffer, Statistics.Unsupported);
+    PutCodes(Buffer, Statistics.Ignored);
+
+    HEADER Header;
+    memcpy(Header.Magic, "D2GM", 4);
+    Header.Version     = FormatVersion;
+    Header.ByteOrder   = 0x01020304;
+    Header.Flags       = (Error            ? Flag_Error            : 0) |
+                         (RecognisedFormat ? Flag_RecognisedFormat : 0);
+    Header.Key         = Key;
+    Header.Checksum    = Hash(Data(), Length(), Hash(Buffer.data(), Buffer.length()));
+    Header.Diagnostics = Diagnostics.size();
+    Header.Length      = Length();
+
+    FILE* File = fopen(Filename, "wb");
+    if(!File) return false;
+
+    bool Result =
+        fwrite(&Header, sizeof(Header), 1, File) == 1 &&
+        fwrite(Buffer.data(), 1, Buffer.length(), File) == Buffer.length() &&
+        fwrite(Data(), 1, Length(), File) == Length();
+
+    if(fclose(File)) Result = false;
+    return Result;
+}
+//------------------------------------------------------------------------------
+
+bool MODEL::Load(const char* Filename){
+    Clear();
+    Diagnostics.clear();
+    Statistics .Clear();
+
+    FILE* File = fopen(Filename, "rb");
+    if(!File) return false;
+
+    HEADER Header;
+    std::string Buffer;
+    char Block[0x10000];
+    size_t Count;
+
+    bool Result = fread(&Header, sizeof(Header), 1, File) == 1;
+    if(Result){
+        while((Count = fread(Block, 1, sizeof(Block), File))) Buffer.append(Block, Count);
+        Result = !ferror(File);
+    }
+    fclose(File);
+
+    if(!Result                               ||
+       memcmp(Header.Magic, "D2GM", 4)       ||
+       Header.Version   != FormatVersion     ||
+       Header.ByteOrder != 0x01020304        ||
+       Header.Length     > Buffer.length()   ) return false;
+
+    const char* Data = Buffer.data();
+    const char* Ops  = Data + Buffer.length() - Header.Length;
+    uint64_t    Sum  = Hash(Ops, Header.Length, Hash(Data, Ops - Data));
+    if(Sum != Header.Checksum) return false;
+
+    std::vector<DIAGNOSTIC> List;
+    for(uint64_t n = 0; n < Header.Diagnostics; n++){
+        if(Ops - Data < 16) return false;
+
+        DIAGNOSTIC Diagnostic;
+        Diagnostic.Level       = (DIAGNOSTIC::LEVEL)GetInt(Data);
+        Diagnostic.LineNumber  = GetInt(Data);
+        Diagnostic.Unsupported = GetInt(Data);
+        uint32_t Length        = GetInt(Data);
+        if((uint64_t)(Ops - Data) < Length) return false;
+
+        Diagnostic.Message.assign(Data, Length);
+        Data += Length;
+        List.push_back(Diagnostic);
+    }
+
+    STATISTICS Counters;
+    if(Ops - Data < 4) return false;
+    uint32_t Tools = GetInt(Data);
+    for(uint32_t n = 0; n < Tools; n++){
+        if(Ops - Data < 44) return false;
+
+        TOOL_COUNTS& Counts = Counters.Tools[GetInt(Data)];
+        Counts.Hits    = GetCount(Data);
+        Counts.Slots   = GetCount(Data);
+        Counts.Routes  = GetCount(Data);
+        Counts.Arcs    = GetCount(Data);
+        Counts.Repeats = GetCount(Data);
+    }
+    if(!GetCodes(Data, Ops, Counters.Unsupported) ||
+       !GetCodes(Data, Ops, Counters.Ignored    ) ||
+       Data != Ops) return false;
+
+    Overflow(Header.Length);
+    memcpy(Position, Ops, Header.Length);
+    Position += Header.Length;
+
+    Diagnostics.swap(List);
+    Statistics.Add(Counters);
+
+    Key              = Header.Key;
+    Error            = Header.Flags & Flag_Error;
+    RecognisedFormat = Header.Flags & Flag_RecognisedFormat;
+    return true;
+}
+//------------------------------------------------------------------------------
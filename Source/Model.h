@@ -0,0 +1,98 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Model_h
+#define Model_h
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "Converter.h"
+#include "Record.h"
+//------------------------------------------------------------------------------
+
+// Fast non-cryptographic 64-bit hash, used for cache keys and checksums
+uint64_t Hash(const void* Data, size_t Length, uint64_t Seed = 0);
+//------------------------------------------------------------------------------
+
+// The parsed drill model in a compact binary form: the plotter operations of
+// a conversion (see RECORDER), in the order of the drill file, so the
+// apertures, tool selections, hits and routes are interleaved as they were
+// read.  The operations are not grouped or indexed by tool.  The diagnostics and the counters of the
+// statistics are kept with it, so that the conversion can be reproduced
+// without parsing the drill file.
+//
+// A saved model starts with a header, in native byte order, followed by the
+// diagnostics, the counters and then the operations.  Each diagnostic is
+// stored as its level, line number, unsupported flag and message length
+// (4 bytes each), followed by the message text.  The counters are stored as
+// the number of tools (4 bytes), then each tool number (4 bytes) and its
+// counts (8 bytes each), followed by the unsupported and then the ignored
+// codes: the number of codes (4 bytes), then each count (8 bytes) and name
+// length (4 bytes), followed by the name.
+class MODEL: public RECORDER{
+    public:
+        struct HEADER{
+            char     Magic[4];    // "D2GM"
+            uint32_t Version;     // Of the format
+            uint32_t ByteOrder;   // 0x01020304
+            uint32_t Flags;       // Flag_...
+            uint64_t Key;         // Identifies the input
+            uint64_t Checksum;    // Of everything after the header
+            uint64_t Diagnostics; // Count
+            uint64_t Length;      // Of the operations, in bytes
+        };
+        enum FLAG{
+            Flag_Error            = 0x01,
+            Flag_RecognisedFormat = 0x02
+        };
+        static const uint32_t FormatVersion = 2;
+
+        uint64_t Key;
+
+        bool Error;
+        bool RecognisedFormat;
+
+        std::vector<DIAGNOSTIC> Diagnostics;
+        STATISTICS              Statistics; // Counters only
+
+        MODEL();
+
+        // Takes the result of a conversion into this model
+        void SetResult(const CONVERTER& Converter);
+
+        // Return false on failure.  Load also fails if the file is not a
+        // valid model, leaving this one empty.
+        bool Save(const char* Filename) const;
+        bool Load(const char* Filename);
+
+        // Passes the operations on to the plotter
+        inline void Replay(PLOTTER* Plotter) const{
+            ::Replay(Data(), Length(), Plotter);
+        }
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
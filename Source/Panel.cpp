@@ -0,0 +1,191 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Panel.h"
+//------------------------------------------------------------------------------
+
+PANEL::PANEL(
+    PLOTTER* Output,
+    int      Columns,
+    int      Rows,
+    double   PitchX,
+    double   PitchY,
+    int      Rotation
+): FILTER(Output){
+    this->Columns = Columns > 0 ? Columns : 1;
+    this->Rows    = Rows    > 0 ? Rows    : 1;
+    this->PitchX  = PitchX;
+    this->PitchY  = PitchY;
+
+    Rotation %= 360;
+    if(Rotation < 0) Rotation += 360;
+    this->Rotation = Rotation / 90;
+
+    OffsetX   = OffsetY = 0;
+    Begun     = false;
+    InBlock   = false;
+    Unrolling = false;
+    CountX    = CountY     = 0;
+    BlockStepX = BlockStepY = 0;
+
+    // The converter's default format, until it specifies one
+    SetUnits(true, 3);
+}
+//------------------------------------------------------------------------------
+
+void PANEL::SetUnits(bool Metric, int FractionDigits){
+    double Scale = pow(10.0, FractionDigits);
+    if(!Metric) Scale /= 25.4;
+
+    StepX = (int)round(PitchX * Scale);
+    StepY = (int)round(PitchY * Scale);
+    BaseX = StepX < 0 ? (Columns-1) * StepX : 0;
+    BaseY = StepY < 0 ? (Rows   -1) * StepY : 0;
+}
+//------------------------------------------------------------------------------
+
+void PANEL::Format(bool Metric, int IntDigits, int FractionDigits){
+    SetUnits(Metric, FractionDigits);
+    Output->Format(Metric, IntDigits, FractionDigits);
+}
+//------------------------------------------------------------------------------
+
+void PANEL::Begin(){
+    Output->Begin();
+    Output->StepRepeat(Columns, Rows, abs(StepX), abs(StepY));
+    Begun = true;
+}
+//------------------------------------------------------------------------------
+
+void PANEL::End(){
+    Finish();
+    Output->End();
+}
+//------------------------------------------------------------------------------
+
+void PANEL::Select(int Code){
+    if(InBlock && !Unrolling) Block.Select(Code);
+    else                      Output->Select(Code);
+}
+//------------------------------------------------------------------------------
+
+void PANEL::Linear(){
+    if(InBlock && !Unrolling) Block.Linear();
+    else                      Output->Linear();
+}
+//------------------------------------------------------------------------------
+
+void PANEL::Circular(bool CCW){
+    if(InBlock && !Unrolling) Block.Circular(CCW);
+    else                      Output->Circular(CCW);
+}
+//------------------------------------------------------------------------------
+
+void PANEL::Flash(int X, int Y){
+    if(InBlock && !Unrolling){
+        Block.Flash(X, Y);
+        return;
+    }
+    Transform(&X, &Y);
+    Output->Flash(X, Y);
+}
+//------------------------------------------------------------------------------
+
+void PANEL::Move(int X, int Y){
+    if(InBlock && !Unrolling){
+        Block.Move(X, Y);
+        return;
+    }
+    Transform(&X, &Y);
+    Output->Move(X, Y);
+}
+//------------------------------------------------------------------------------
+
+void PANEL::Draw(int X, int Y){
+    if(InBlock && !Unrolling){
+        Block.Draw(X, Y);
+        return;
+    }
+    Transform(&X, &Y);
+    Output->Draw(X, Y);
+}
+//------------------------------------------------------------------------------
+
+// The centre offset is a vector, so it is rotated but not moved
+void PANEL::Arc(int X, int Y, int I, int J){
+    if(InBlock && !Unrolling){
+        Block.Arc(X, Y, I, J);
+        return;
+    }
+    Transform(&X, &Y);
+    Rotate   (&I, &J);
+    Output->Arc(X, Y, I, J);
+}
+//------------------------------------------------------------------------------
+
+void PANEL::Circle(int X, int Y, int R){
+    if(InBlock && !Unrolling){
+        Block.Circle(X, Y, R);
+        return;
+    }
+    Transform(&X, &Y);
+    Output->Circle(X, Y, R);
+}
+//------------------------------------------------------------------------------
+
+void PANEL::StepRepeat(int CountX, int CountY, int StepX, int StepY){
+    if(InBlock) return; // Not nested in the input either
+
+    InBlock      = true;
+    this->CountX = CountX;
+    this->CountY = CountY;
+    BlockStepX   = StepX;
+    BlockStepY   = StepY;
+    Block.Clear();
+}
+//------------------------------------------------------------------------------
+
+// Passes every copy of the block on, offset on the board before rotation
+void PANEL::EndStepRepeat(){
+    if(!InBlock || Unrolling) return;
+
+    Unrolling = true;
+    for(int y = 0; y < CountY; y++){
+        for(int x = 0; x < CountX; x++){
+            OffsetX = x * BlockStepX;
+            OffsetY = y * BlockStepY;
+            Replay(Block.Data(), Block.Length(), this);
+        }
+    }
+    Unrolling = false;
+    OffsetX   = OffsetY = 0;
+    InBlock   = false;
+    Block.Clear();
+}
+//------------------------------------------------------------------------------
+
+void PANEL::Finish(){
+    if(InBlock) EndStepRepeat();
+    if(Begun){
+        Output->EndStepRepeat();
+        Begun = false;
+    }
+}
+//------------------------------------------------------------------------------
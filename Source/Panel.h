@@ -0,0 +1,105 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Panel_h
+#define Panel_h
+//------------------------------------------------------------------------------
+
+#include <math.h>
+
+#include "Filter.h"
+#include "Record.h"
+//------------------------------------------------------------------------------
+
+// Steps the board into a panel of Columns by Rows copies, by wrapping the
+// whole drawing in one step-and-repeat block, so that the output does not
+// grow with the number of copies.  The board can be rotated by a multiple of
+// 90 degrees (counter-clockwise) about its origin first.  Either pitch can be
+// negative, in which case the panel grows to the left or down from the
+// board.
+//
+// Step-and-repeat blocks cannot be nested, so blocks of the board itself are
+// recorded and unrolled in memory instead.
+class PANEL: public FILTER{
+    private:
+        int    Columns, Rows;
+        double PitchX, PitchY; // mm
+        int    Rotation;       // Quarter turns
+
+        int StepX, StepY;     // In file units
+        int BaseX, BaseY;     // Offset of the first copy
+        int OffsetX, OffsetY; // Of the copy of a board block being unrolled
+
+        bool Begun;
+
+        // A block of the board, while it is being recorded or unrolled
+        RECORDER Block;
+        bool     InBlock;
+        bool     Unrolling;
+        int      CountX, CountY;
+        int      BlockStepX, BlockStepY;
+
+        void SetUnits(bool Metric, int FractionDigits);
+
+        inline void Rotate(int* X, int* Y) const{
+            int x = *X, y = *Y;
+            switch(Rotation){
+                case 1: *X = -y; *Y =  x; break;
+                case 2: *X = -x; *Y = -y; break;
+                case 3: *X =  y; *Y = -x; break;
+                default: break;
+            }
+        }
+
+        // A point on the board to the first copy on the panel
+        inline void Transform(int* X, int* Y) const{
+            *X += OffsetX;
+            *Y += OffsetY;
+            Rotate(X, Y);
+            *X += BaseX;
+            *Y += BaseY;
+        }
+
+    public:
+        // The rotation is in degrees, and must be a multiple of 90
+        PANEL(PLOTTER* Output, int Columns, int Rows, double PitchX, double PitchY, int Rotation = 0);
+
+        void Format       (bool Metric, int IntDigits, int FractionDigits);
+        void Begin        ();
+        void End          ();
+        void Select       (int Code);
+        void Linear       ();
+        void Circular     (bool CCW);
+        void Flash        (int X, int Y);
+        void Move         (int X, int Y);
+        void Draw         (int X, int Y);
+        void Arc          (int X, int Y, int I, int J);
+        void Circle       (int X, int Y, int R);
+        void StepRepeat   (int CountX, int CountY, int StepX, int StepY);
+        void EndStepRepeat();
+
+        // Closes the panel block if the input did not end.  Flush leaves it
+        // open, so that it can be used mid-stream.
+        void Finish();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,309 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+// Converts a single file on several threads.
+//
+// The header is converted serially.  A pre-scan then splits the body into
+// parts, preferably at tool changes, and predicts the modal state (tool,
+// routing mode and Z-axis) at the start of every part.  The parts are
+// converted in parallel, treating the coordinate state as unknown.
+//
+// The parts are then joined in order.  A part is redone serially, from the
+// exact state at the end of the previous part, when the prediction was wrong
+// or when it used coordinates from before its start (an X-only line, an arc
+// or repeat relative to the previous position, etc.)  The parts record their
+// output, which is replayed in order, so the output is exactly that of a
+// serial conversion.
+//------------------------------------------------------------------------------
+
+#include "Converter.h"
+#include "Record.h"
+#include "ThreadPool.h"
+//------------------------------------------------------------------------------
+
+// Smaller inputs are converted serially
+static const size_t MinimumParallelSize = 0x400000;
+
+// Parts are split at tool changes once they reach this size, or at any
+// coordinate line when they reach four times this size
+static const size_t MinimumPartSize = 0x100000;
+//------------------------------------------------------------------------------
+
+struct PART{
+    size_t Start;
+    size_t Length;
+    int    LineNumber; // Of the line before the part
+
+    CONVERTER::STATE Guess;
+
+    CONVERTER  Converter;
+    RECORDER   Output;
+    PHASE_TIME Time; // Of all the attempts
+
+    std::atomic<int> Pending;
+};
+//------------------------------------------------------------------------------
+
+// Predicts the modal state after the line
+static void PreScan(const LINE& Line, CONVERTER::STATE& State){
+    int CharCount = 0;
+
+    switch(Line[0]){
+        case 'T':
+            State.Tool = 0;
+            for(int j = 1; Line[j] >= '0' && Line[j] <= '9'; j++){
+                State.Tool = 10*State.Tool + Line[j] - '0';
+            }
+            State.ToolSelected = true;
+            return;
+
+        case 'M':
+            if(Line[1] == '1' && Line[2] == '5'){
+                State.Z_Axis = CONVERTER::Z_Routing;
+
+            }else if(Line[1] == '1' && (Line[2] == '6' || Line[2] == '7')){
+                State.Z_Axis = CONVERTER::Z_Retracted;
+
+            }else if(Line[1] == '0' && Line[2] == '0'){
+                State.Tool++;
+                State.ToolSelected = true;
+            }
+            return;
+
+        case 'G':
+            CharCount = 3;
+            if(Line[1] == '0'){
+                switch(Line[2]){
+                    case '0': State.Mode = CONVERTER::Mode_Route_Move;   break;
+                    case '1': State.Mode = CONVERTER::Mode_Route_Linear; break;
+                    case '2': State.Mode = CONVERTER::Mode_Route_CW;     break;
+                    case '3': State.Mode = CONVERTER::Mode_Route_CCW;    break;
+                    case '5':
+                        State.Mode   = CONVERTER::Mode_Drill;
+                        State.Z_Axis = CONVERTER::Z_Retracted;
+                        break;
+                    default: break;
+                }
+            }else if(Line[1] == '3' && Line[2] == '2'){
+                State.Mode = CONVERTER::Mode_Route_Canned_CW;
+            }else if(Line[1] == '3' && Line[2] == '3'){
+                State.Mode = CONVERTER::Mode_Route_Canned_CCW;
+            }else if(Line[1] == '8' && Line[2] == '1'){
+                State.Mode   = CONVERTER::Mode_Drill;
+                State.Z_Axis = CONVERTER::Z_Retracted;
+            }
+            break;
+
+        case 'X':
+        case 'Y':
+        case 'I':
+        case 'J':
+        case 'A':
+            break;
+
+        default:
+            return;
+    }
+
+    // Embedded slot, which ends in drill mode
+    for(int j = CharCount; j+2 < Line.Length; j++){
+        if(Line[j] == 'G' && Line[j+1] == '8' && Line[j+2] == '5'){
+            State.Mode   = CONVERTER::Mode_Drill;
+            State.Z_Axis = CONVERTER::Z_Retracted;
+            return;
+        }
+    }
+}
+//------------------------------------------------------------------------------
+
+static bool SameModalState(const CONVERTER::STATE& A, const CONVERTER::STATE& B){
+    return A.Tool         == B.Tool         &&
+           A.ToolSelected == B.ToolSelected &&
+           A.Mode         == B.Mode         &&
+           A.Z_Axis       == B.Z_Axis       &&
+           A.Header       == B.Header;
+}
+//------------------------------------------------------------------------------
+
+static void ConvertPart(
+    PART*                     Part,
+    const char*               Data,
+    const CONVERTER::OPTIONS& Options,
+    const CONVERTER::STATE&   State,
+    bool                      Speculative
+){
+    READER    Reader;
+    LINE      Line;
+    STOPWATCH Watch;
+
+    Part->Output.Clear();
+    Part->Converter.Options = Options;
+    Part->Converter.Begin   (&Part->Output);
+    Part->Converter.SetState(State, Part->LineNumber, Speculative);
+
+    Reader.Open(Data + Part->Start, Part->Length);
+    while(Reader.ReadLine(Line)) Part->Converter.Convert(Line);
+
+    Part->Converter.Flush();
+    Watch.Split(Part->Time);
+}
+//------------------------------------------------------------------------------
+
+bool CONVERTER::Convert(READER* Input, SINK* Output, THREAD_POOL* Pool){
+    Gerber.Open(Output);
+    return Convert(Input, &Gerber, Pool);
+}
+//------------------------------------------------------------------------------
+
+bool CONVERTER::Convert(READER* Input, PLOTTER* Output, THREAD_POOL* Pool){
+    const char* Data;
+    size_t      Length, Offset;
+
+    if(!Pool || Pool->Size() < 2) return Convert(Input, Output);
+
+    // Block reads still benefit from overlapping the input and output
+    if(!Input->GetData(&Data, &Length, &Offset)){
+        return ConvertPipelined(Input, Output);
+    }
+    if(Length - Offset < MinimumParallelSize) return Convert(Input, Output);
+
+    LINE       Line;
+    STOPWATCH  Watch;
+    PHASE_TIME Joining;
+
+    Begin(Output);
+    while(Header && Input->ReadLine(Line)) Convert(Line);
+    Input->GetData(&Data, &Length, &Offset);
+
+    STATE State;
+    GetState(&State);
+    //--------------------------------------------------------------------------
+
+    // Pre-scan: split the body into parts
+    size_t PartSize = (Length - Offset) / (8 * Pool->Size());
+    if(PartSize < MinimumPartSize) PartSize = MinimumPartSize;
+
+    std::vector<PART*> Parts;
+
+    READER Scanner;
+    Scanner.Open(Data + Offset, Length - Offset);
+
+    const char* Body;
+    size_t      BodyLength, Position;
+    bool        Split = true;
+    STATE       Guess = State;
+
+    PART* Part       = new PART;
+    Part->Start      = Offset;
+    Part->LineNumber = LineNumber;
+    Part->Guess      = Guess;
+    Parts.push_back(Part);
+
+    int Number = LineNumber;
+    while(true){
+        Scanner.GetData(&Body, &BodyLength, &Position);
+        if(!Scanner.ReadLine(Line)) break;
+
+        size_t Size = Offset + Position - Part->Start;
+        if(Split && (
+            (Size >=   PartSize && Line[0] == 'T') ||
+            (Size >= 4*PartSize && Line[0] == 'X')
+        )){
+            Part->Length = Size;
+
+            Part             = new PART;
+            Part->Start      = Offset + Position;
+            Part->LineNumber = Number;
+            Part->Guess      = Guess;
+            Parts.push_back(Part);
+        }
+        Number++;
+
+        // Re-entering the header changes the format: the rest is one part
+        if(Line[0] == 'M' && Line[1] == '4' && Line[2] == '8') Split = false;
+
+        PreScan(Line, Guess);
+    }
+    Part->Length = Length - Part->Start;
+    Watch.Split(Statistics.Read);
+    //--------------------------------------------------------------------------
+
+    // Convert the parts speculatively, keeping a limited number in flight,
+    // and join them in order
+    size_t Window   = 2 * Pool->Size();
+    size_t Launched = 0;
+
+    for(size_t n = 0; n < Parts.size(); n++){
+        for(; Launched < Parts.size() && Launched < n + Window; Launched++){
+            PART* Next = Parts[Launched];
+            Next->Pending = 1;
+            Pool->Add([Next, Data, this]{
+                ConvertPart(Next, Data, Options, Next->Guess, true);
+                Next->Pending--;
+            });
+        }
+        Part = Parts[n];
+        Pool->Wait(Part->Pending);
+
+        if(Part->Converter.Dependent || !SameModalState(Part->Guess, State)){
+            ConvertPart(Part, Data, Options, State, false);
+        }
+
+        // The state at the end of this part is the exact start of the next
+        STATE    Next;
+        unsigned Known = Part->Converter.GetKnown();
+        Part->Converter.GetState(&Next);
+        if(!(Known & Known_X)) Next.X = State.X;
+        if(!(Known & Known_Y)) Next.Y = State.Y;
+        if(!(Known & Known_I)) Next.I = State.I;
+        if(!(Known & Known_J)) Next.J = State.J;
+        if(!(Known & Known_R)) Next.R = State.R;
+        if(!(Known & Known_P)){
+            Next.pX = State.pX;
+            Next.pY = State.pY;
+        }
+        State = Next;
+        Watch.Split(Joining);
+
+        Replay(Part->Output.Data(), Part->Output.Length(), Plotter);
+        Watch.Split(Statistics.Emit);
+
+        const std::vector<DIAGNOSTIC>& Messages = Part->Converter.Diagnostics;
+        Diagnostics.insert(Diagnostics.end(), Messages.begin(), Messages.end());
+        if(Part->Converter.Error) Error = true;
+
+        // This thread helps with the parts while joining, so only its wall
+        // time counts towards the parse
+        Statistics.Add(Part->Converter.Statistics);
+        Statistics.Parse.CPU += Part->Time.CPU;
+
+        delete Part;
+        Parts[n] = 0;
+    }
+    //--------------------------------------------------------------------------
+
+    Statistics.Parse.Wall += Joining.Wall;
+
+    SetState(State, Number, false);
+    bool Result = End();
+    Watch.Split(Statistics.Emit);
+    return Result;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,332 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+// Converts a single file in three pipelined stages, each on its own thread:
+//
+// - The reader passes the input on in blocks that end on a line boundary.
+//   Mapped files are passed on as views, after touching every page so that
+//   the parser does not wait for the disk; other input is copied.
+// - The parser converts the lines and records the plotter operations.
+// - The writer replays the records into the output plotter.
+//
+// The stages are connected by single-producer, single-consumer ring buffers.
+// Blocks are recycled through a second ring buffer going the other way, so
+// the memory in use is bounded.  When a block cannot be allocated, the stage
+// waits for one of its blocks in use instead, and if it has none, it ends
+// its output with a failed block, which is reported as an error.
+//------------------------------------------------------------------------------
+
+#include "Converter.h"
+#include "Record.h"
+#include "RingBuffer.h"
+//------------------------------------------------------------------------------
+
+static const size_t InputBlockSize  = 0x100000;
+static const size_t RecordBlockSize = 0x40000;
+static const int    Blocks          = 8; // Per stage
+//------------------------------------------------------------------------------
+
+struct BLOCK{
+    char*  Data;     // Null marks the end of the input
+    size_t Length;
+    size_t Capacity; // Zero for views of the input, which are not recycled
+    bool   Failed;   // At the end: the producer ran out of memory
+};
+
+typedef RING_BUFFER<BLOCK, Blocks> BLOCK_QUEUE;
+//------------------------------------------------------------------------------
+
+// Takes a block to fill: a new one while fewer than Blocks are in use,
+// otherwise one that the consumer is done with.  Returns false if there is
+// no memory for it, in which case the block is a recycled one that is too
+// small, or has a null Data.
+static bool GetBlock(BLOCK_QUEUE* Free, int* Allocated, size_t Size, BLOCK* Block){
+    if(*Allocated < Blocks){
+        char* Data = (char*)malloc(Size);
+        if(Data){
+            Block->Data     = Data;
+            Block->Length   = 0;
+            Block->Capacity = Size;
+            Block->Failed   = false;
+            (*Allocated)++;
+            return true;
+        }
+        // Make do with the blocks in use, which the consumer gives back
+        if(!*Allocated) return false;
+        *Allocated = Blocks;
+    }
+
+    *Block = Free->Pop();
+    Block->Length = 0;
+    Block->Failed = false;
+
+    if(Block->Capacity < Size){
+        char* New = (char*)realloc(Block->Data, Size);
+        if(!New) return false;
+        Block->Data     = New;
+        Block->Capacity = Size;
+    }
+    return true;
+}
+//------------------------------------------------------------------------------
+
+static void FreeBlocks(BLOCK_QUEUE* Free){
+    BLOCK Block;
+    while(Free->TryPop(&Block)) free(Block.Data);
+}
+//------------------------------------------------------------------------------
+
+static void ReadStage(
+    READER*      Input,
+    BLOCK_QUEUE* Full,
+    BLOCK_QUEUE* Free,
+    PHASE_TIME*  Time
+){
+    STOPWATCH   Watch;
+    const char* Data;
+    size_t      Length, Offset;
+    BLOCK       Block;
+    bool        Failed = false;
+
+    if(Input->GetData(&Data, &Length, &Offset)){
+        volatile char Touch = 0;
+
+        while(Offset < Length){
+            size_t Size = InputBlockSize;
+            if(Size > Length - Offset) Size = Length - Offset;
+
+            // Extend to the end of the line
+            const char* Stop = (const char*)memchr(
+                Data + Offset + Size - 1, '\n', Length - Offset - Size + 1
+            );
+            if(Stop) Size = Stop - (Data + Offset) + 1;
+            else     Size = Length - Offset;
+
+            for(size_t n = 0; n < Size; n += 0x1000) Touch = Data[Offset + n];
+
+            Block.Data     = (char*)Data + Offset;
+            Block.Length   = Size;
+            Block.Capacity = 0;
+            Block.Failed   = false;
+            Full->Push(Block);
+
+            Offset += Size;
+        }
+        (void)Touch;
+
+    }else{
+        int  Allocated = 0;
+        LINE Line;
+
+        Block.Data     = 0;
+        Block.Length   = 0;
+        Block.Capacity = 0;
+        Failed = !GetBlock(Free, &Allocated, InputBlockSize, &Block);
+
+        while(!Failed && Input->ReadLine(Line)){
+            size_t Size = Line.Length + 1;
+
+            if(Block.Capacity - Block.Length < Size){
+                if(Block.Length){
+                    Full->Push(Block);
+                }else{
+                    free(Block.Data);
+                    Allocated--;
+                }
+                Block.Data = 0;
+                Failed = !GetBlock(Free, &Allocated,
+                    Size > InputBlockSize ? Size : InputBlockSize, &Block
+                );
+                if(Failed) break; // Freed below, as it is empty
+            }
+            memcpy(Block.Data + Block.Length, Line.Data, Line.Length);
+            Block.Length += Size;
+            Block.Data[Block.Length-1] = '\n';
+        }
+        if(Block.Length) Full->Push(Block);
+        else             free(Block.Data);
+    }
+
+    Block.Data   = 0;
+    Block.Failed = Failed;
+    Full->Push(Block);
+    Watch.Split(*Time);
+}
+//------------------------------------------------------------------------------
+
+static bool WriteStage(
+    PLOTTER*     Output,
+    BLOCK_QUEUE* Full,
+    BLOCK_QUEUE* Free,
+    PHASE_TIME*  Time
+){
+    STOPWATCH Watch;
+
+    while(true){
+        BLOCK Block = Full->Pop();
+        if(!Block.Data) break;
+
+        Replay(Block.Data, Block.Length, Output);
+        Free->Push(Block);
+    }
+    bool Result = Output->Flush();
+    Watch.Split(*Time);
+    return Result;
+}
+//------------------------------------------------------------------------------
+
+// Passes full record blocks on to the writer stage
+class PIPE_RECORDER: public RECORDER{
+    private:
+        BLOCK_QUEUE* Full;
+        BLOCK_QUEUE* Free;
+        int          Allocated;
+
+        void Send(size_t Size){
+            BLOCK Block;
+            Block.Data     = Buffer;
+            Block.Length   = Position - Buffer;
+            Block.Capacity = Limit    - Buffer;
+            Block.Failed   = false;
+            Full->Push(Block);
+
+            if(!GetBlock(Free, &Allocated, Size, &Block)) Fail();
+            Buffer   = Block.Data;
+            Position = Buffer;
+            Limit    = Buffer + Block.Capacity;
+        }
+
+        // Ends the output of the writer stage, which then sees the failure
+        void Fail(){
+            Failed = true;
+
+            BLOCK Block;
+            Block.Data   = 0;
+            Block.Failed = true;
+            Full->Push(Block);
+        }
+
+    protected:
+        // After a failure, the records are discarded in the block at hand,
+        // which is only grown for a record that does not fit at all
+        void Overflow(size_t Size){
+            if(!Failed) Send(Size > RecordBlockSize ? Size : RecordBlockSize);
+
+            if(Failed){
+                Position = Buffer;
+                if(Size > (size_t)(Limit - Buffer)) RECORDER::Overflow(Size);
+            }
+        }
+
+    public:
+        bool Written; // Result of the writer stage, once it finished
+        bool Failed;  // Ran out of memory for the records
+
+        PIPE_RECORDER(BLOCK_QUEUE* Full, BLOCK_QUEUE* Free):
+            RECORDER(RecordBlockSize)
+        {
+            this->Full = Full;
+            this->Free = Free;
+            Allocated  = 1;
+            Written    = true;
+            Failed     = false;
+
+            if(!Buffer){
+                Limit     = Buffer;
+                Allocated = 0;
+                Fail();
+            }
+        }
+
+        bool Flush(){
+            if(!Failed && Position > Buffer) Send(RecordBlockSize);
+            return Written;
+        }
+
+        void Close(){
+            Flush();
+            if(Failed) return; // Already ended
+
+            BLOCK Block;
+            Block.Data   = 0;
+            Block.Failed = false;
+            Full->Push(Block);
+        }
+};
+//------------------------------------------------------------------------------
+
+bool CONVERTER::ConvertPipelined(READER* Input, SINK* Output){
+    Gerber.Open(Output);
+    return ConvertPipelined(Input, &Gerber);
+}
+//------------------------------------------------------------------------------
+
+bool CONVERTER::ConvertPipelined(READER* Input, PLOTTER* Output){
+    BLOCK_QUEUE InputFull, InputFree;
+    BLOCK_QUEUE RecordFull, RecordFree;
+
+    PIPE_RECORDER Recorder(&RecordFull, &RecordFree);
+
+    bool       Written = false;
+    PHASE_TIME ReadTime, WriteTime;
+    STOPWATCH  Watch;
+
+    std::thread Reader(ReadStage, Input, &InputFull, &InputFree, &ReadTime);
+    std::thread Writer([&]{
+        Written = WriteStage(Output, &RecordFull, &RecordFree, &WriteTime);
+    });
+
+    READER Lines;
+    LINE   Line;
+    bool   ReadFailed = false;
+
+    Begin(&Recorder);
+    while(true){
+        BLOCK Block = InputFull.Pop();
+        if(!Block.Data){
+            ReadFailed = Block.Failed;
+            break;
+        }
+
+        Lines.Open(Block.Data, Block.Length);
+        while(Lines.ReadLine(Line)) Convert(Line);
+
+        if(Block.Capacity) InputFree.Push(Block);
+    }
+    Recorder.Close();
+    Watch.Split(Statistics.Parse);
+
+    Reader.join();
+    Writer.join();
+
+    Statistics.Read = ReadTime;
+    Statistics.Emit = WriteTime;
+
+    FreeBlocks(&InputFree);
+    FreeBlocks(&RecordFree);
+
+    LineNumber = 0;
+    if(ReadFailed     ) Report(DIAGNOSTIC::Error, false, "Out of memory while reading the input");
+    if(Recorder.Failed) Report(DIAGNOSTIC::Error, false, "Out of memory while recording the output");
+
+    Recorder.Written = Written;
+    return End();
+}
+//------------------------------------------------------------------------------
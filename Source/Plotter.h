@@ -0,0 +1,62 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Plotter_h
+#define Plotter_h
+//------------------------------------------------------------------------------
+
+// Receives the output of a conversion as drawing operations.  Coordinates are
+// integers in the file format units.  The Gerber writer is one plotter; others
+// record the operations, or pass them on to another plotter.
+class PLOTTER{
+    public:
+        virtual ~PLOTTER(){}
+
+        virtual void Format  (bool Metric, int IntDigits, int FractionDigits) = 0;
+        virtual void Aperture(int Code, const char* Diameter, int Length) = 0;
+        virtual void Begin   () = 0; // Dark polarity and linear interpolation
+        virtual void End     () = 0;
+
+        virtual void Select  (int Code) = 0;
+        virtual void Linear  () = 0;
+        virtual void Circular(bool CCW) = 0;
+
+        virtual void Flash(int X, int Y) = 0;
+        virtual void Move (int X, int Y) = 0;
+        virtual void Draw (int X, int Y) = 0;
+
+        // Arc from the current point to (X, Y), with centre offset (I, J)
+        virtual void Arc(int X, int Y, int I, int J) = 0;
+
+        // Full circle of radius R around (X, Y), ending at the centre
+        virtual void Circle(int X, int Y, int R) = 0;
+
+        // Opens a step-and-repeat block: CountX by CountY copies of the
+        // block content, spaced StepX and StepY (>= 0) apart
+        virtual void StepRepeat   (int CountX, int CountY, int StepX, int StepY) = 0;
+        virtual void EndStepRepeat() = 0;
+
+        // Passes buffered output on.  Returns false if any output failed.
+        virtual bool Flush() = 0;
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
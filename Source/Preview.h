@@ -0,0 +1,146 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Preview_h
+#define Preview_h
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Filter.h"
+#include "ThreadPool.h"
+//------------------------------------------------------------------------------
+
+// Draws the holes and routes into a greyscale bitmap, dark on white, while
+// passing everything on unchanged.
+//
+// The operations are kept as flashes, straight strokes and arcs in mm, with
+// step-and-repeat blocks expanded.  The image is rendered in square tiles,
+// in parallel on the pool: every primitive is first binned into the tiles
+// that its bounding box touches, so that every tile only visits what can
+// cover it.  Edges are anti-aliased from the distance to the outline.
+class PREVIEW: public FILTER{
+    private:
+        struct DISK{
+            float X, Y, R;
+        };
+        struct SEGMENT{
+            float X0, Y0, X1, Y1, R; // R is half the aperture
+        };
+        struct ARC{
+            float X, Y, Radius; // Centre and radius
+            float Start, Sweep; // Counter-clockwise, in radians
+            float R;            // Half the aperture
+        };
+
+        std::vector<DISK>    Disks;
+        std::vector<SEGMENT> Segments;
+        std::vector<ARC>     Arcs;
+
+        double Dpi;
+
+        // Of the recording, in mm
+        double Scale; // mm per file unit
+        bool   Metric;
+        float  R;     // Half the aperture
+        bool   CCW;
+        int    X, Y;  // Current point in file units
+
+        std::map<int, double> Apertures; // Diameters in mm
+
+        // Step-and-repeat block being recorded
+        bool   InBlock;
+        size_t BlockDisks, BlockSegments, BlockArcs;
+        int    CountX, CountY;
+        double StepX, StepY; // mm
+
+        // Of the rendering
+        double   Left, Top;   // Of the image in mm
+        double   PixelsPerMm;
+        int      TilesX, TilesY;
+        uint32_t TileCount;
+
+        // Copies of the primitives, sorted by tile
+        template<class T> struct BINS{
+            std::vector<size_t> Start; // Of every tile, and the end
+            std::vector<T>      Items;
+        };
+        BINS<DISK>    DiskBins;
+        BINS<SEGMENT> SegmentBins;
+        BINS<ARC>     ArcBins;
+
+        static void Bounds(const DISK&    Disk,    double* X0, double* Y0, double* X1, double* Y1);
+        static void Bounds(const SEGMENT& Segment, double* X0, double* Y0, double* X1, double* Y1);
+        static void Bounds(const ARC&     Arc,     double* X0, double* Y0, double* X1, double* Y1);
+
+        // Narrows the columns of tiles in a row that the primitive touches
+        void Columns(const DISK&,             int,     int*,     int*    ) const{}
+        void Columns(const SEGMENT& Segment, int Row, int* Tx0, int* Tx1) const;
+        void Columns(const ARC&,              int,     int*,     int*    ) const{}
+
+        template<class T> void Bin(const std::vector<T>& Items, BINS<T>& Bins);
+
+        void Tile(int Index);
+
+        void DrawDisk   (const DISK&    Disk,    int X0, int Y0, int X1, int Y1);
+        void DrawSegment(const SEGMENT& Segment, int X0, int Y0, int X1, int Y1);
+        void DrawArc    (const ARC&     Arc,     int X0, int Y0, int X1, int Y1);
+
+    public:
+        // The rendered image, one byte per pixel, top row first
+        int                  Width, Height;
+        std::vector<uint8_t> Pixels;
+
+        PREVIEW(PLOTTER* Output, double Dpi);
+
+        void Format  (bool Metric, int IntDigits, int FractionDigits);
+        void Aperture(int Code, const char* Diameter, int Length);
+        void Select  (int Code);
+        void Circular(bool CCW);
+
+        void Flash(int X, int Y);
+        void Move (int X, int Y);
+        void Draw (int X, int Y);
+        void Arc   (int X, int Y, int I, int J);
+        void Circle(int X, int Y, int R);
+
+        void StepRepeat   (int CountX, int CountY, int StepX, int StepY);
+        void EndStepRepeat();
+
+        // The number of flashes, strokes and arcs recorded
+        size_t Primitives() const;
+
+        // Renders the image at the resolution given, on the pool if there is
+        // one.  Returns false if the image would be too large.
+        bool Render(THREAD_POOL* Pool);
+
+        // Returns false if the file could not be written
+        bool WritePgm(FILE* File) const;
+        bool WritePng(FILE* File) const;
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,350 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Reader.h"
+//------------------------------------------------------------------------------
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+//------------------------------------------------------------------------------
+
+static const size_t BlockSize = 0x100000;
+//------------------------------------------------------------------------------
+
+READER::READER(){
+    Mapping     = 0;
+    MappingSize = 0;
+    #ifdef _WIN32
+        FileHandle    = INVALID_HANDLE_VALUE;
+        MappingHandle = 0;
+    #endif
+
+    File       = 0;
+    FileSource = 0;
+
+    MappingSource = 0;
+    Gzip          = 0;
+
+    Data     = 0;
+    Length   = 0;
+    Position = 0;
+    Touched  = 0;
+
+    Source       = 0;
+    SourceLength = 0;
+    Buffer       = 0;
+    BufferSize   = 0;
+    Start        = 0;
+    End          = 0;
+    EndOfInput   = false;
+}
+//------------------------------------------------------------------------------
+
+READER::~READER(){
+    Close();
+    if(Buffer) delete[] Buffer;
+}
+//------------------------------------------------------------------------------
+
+bool READER::Open(const char* Filename){
+    Close();
+
+    #ifdef _WIN32
+        HANDLE Handle = CreateFileA(
+            Filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+            FILE_FLAG_SEQUENTIAL_SCAN, 0
+        );
+        if(Handle != INVALID_HANDLE_VALUE){
+            LARGE_INTEGER Size;
+            if(GetFileSizeEx(Handle, &Size) && Size.QuadPart > 0){
+                HANDLE Map = CreateFileMappingA(Handle, 0, PAGE_READONLY, 0, 0, 0);
+                if(Map){
+                    Mapping = MapViewOfFile(Map, FILE_MAP_READ, 0, 0, 0);
+                    if(Mapping){
+                        FileHandle    = Handle;
+                        MappingHandle = Map;
+                        MappingSize   = Size.QuadPart;
+                        OpenMapping();
+                        return true;
+                    }
+                    CloseHandle(Map);
+                }
+            }
+            CloseHandle(Handle);
+        }
+    #else
+        int Handle = open(Filename, O_RDONLY);
+        if(Handle >= 0){
+            struct stat Info;
+            if(!fstat(Handle, &Info) && S_ISREG(Info.st_mode) && Info.st_size > 0){
+                void* Map = mmap(0, Info.st_size, PROT_READ, MAP_PRIVATE, Handle, 0);
+                if(Map != MAP_FAILED){
+                    close(Handle);
+                    madvise(Map, Info.st_size, MADV_SEQUENTIAL);
+                    Mapping     = Map;
+                    MappingSize = Info.st_size;
+                    OpenMapping();
+                    return true;
+                }
+            }
+            close(Handle);
+        }
+    #endif
+
+    // Empty files, pipes and devices cannot be mapped
+    File = fopen(Filename, "rb");
+    if(!File) return false;
+
+    // The data cannot be inspected before reading, so let the
+    // decompressor detect whether it is compressed
+    FileSource = new FILE_SOURCE(File);
+    Gzip       = new GZIP_SOURCE(FileSource);
+    Open(Gzip);
+    return true;
+}
+//------------------------------------------------------------------------------
+
+void READER::Open(FILE* File){
+    Close();
+
+    FileSource = new FILE_SOURCE(File);
+    Gzip       = new GZIP_SOURCE(FileSource);
+    Open(Gzip);
+}
+//------------------------------------------------------------------------------
+
+void READER::OpenMapping(){
+    const char* Data = (const char*)Mapping;
+
+    if(GZIP_SOURCE::IsCompressed(Data, MappingSize)){
+        MappingSource = new MEMORY_SOURCE(Data, MappingSize);
+        Gzip          = new GZIP_SOURCE(MappingSource);
+        Open(Gzip);
+    }else{
+        Open(Data, MappingSize);
+    }
+}
+//------------------------------------------------------------------------------
+
+void READER::Open(const char* Data, size_t Length){
+    if(Data != Mapping) Close();
+
+    this->Data   = Data;
+    this->Length = Length;
+    Position     = 0;
+    Touched      = 0;
+}
+//------------------------------------------------------------------------------
+
+void READER::Open(SOURCE* Source){
+    if(Source != Gzip) Close();
+
+    this->Source = Source;
+    SourceLength = 0;
+    if(!Buffer){
+        BufferSize = BlockSize;
+        Buffer     = new char[BufferSize];
+    }
+    Start      = 0;
+    End        = 0;
+    EndOfInput = false;
+}
+//------------------------------------------------------------------------------
+
+void READER::Close(){
+    if(Mapping){
+        #ifdef _WIN32
+            UnmapViewOfFile(Mapping);
+            CloseHandle(MappingHandle);
+            CloseHandle(FileHandle);
+            FileHandle    = INVALID_HANDLE_VALUE;
+            MappingHandle = 0;
+        #else
+            munmap(Mapping, MappingSize);
+        #endif
+        Mapping     = 0;
+        MappingSize = 0;
+    }
+    if(Gzip){
+        delete Gzip;
+        Gzip = 0;
+    }
+    if(MappingSource){
+        delete MappingSource;
+        MappingSource = 0;
+    }
+    if(FileSource){
+        delete FileSource;
+        FileSource = 0;
+    }
+    if(File){
+        fclose(File);
+        File = 0;
+    }
+    Data         = 0;
+    Length       = 0;
+    Position     = 0;
+    Touched      = 0;
+    Source       = 0;
+    SourceLength = 0;
+}
+//------------------------------------------------------------------------------
+
+void READER::MakeLine(const char* Data, size_t Length, LINE& Line){
+    if(Length && Data[Length-1] == '\r') Length--;
+
+    // Carriage returns are ignored everywhere, not only at the end
+    if(memchr(Data, '\r', Length)){
+        Scratch.clear();
+        for(size_t n = 0; n < Length; n++){
+            if(Data[n] != '\r') Scratch += Data[n];
+        }
+        Data   = Scratch.data();
+        Length = Scratch.length();
+    }
+    Line.Data   = Data;
+    Line.Length = Length;
+}
+//------------------------------------------------------------------------------
+
+// Reads more data after the current partial line, growing the buffer if the
+// line does not fit.  Returns false if nothing more could be read.
+bool READER::Fill(){
+    if(EndOfInput) return false;
+
+    if(Start > 0){
+        memmove(Buffer, Buffer + Start, End - Start);
+        End  -= Start;
+        Start = 0;
+
+    }else if(End == BufferSize){
+        char* New = new char[2*BufferSize];
+        memcpy(New, Buffer, End);
+        delete[] Buffer;
+        Buffer      = New;
+        BufferSize *= 2;
+    }
+
+    STOPWATCH Watch;
+    size_t Count = Source->Read(Buffer + End, BufferSize - End);
+    Watch.Split(Time);
+
+    SourceLength += Count;
+    if(!Count){
+        EndOfInput = true;
+        return false;
+    }
+    End += Count;
+    return true;
+}
+//------------------------------------------------------------------------------
+
+// Faults in the next block of the mapping, or buffer
+void READER::Touch(){
+    STOPWATCH Watch;
+
+    if(Touched < Position) Touched = Position;
+    size_t Stop = Touched + BlockSize;
+    if(Stop > Length) Stop = Length;
+
+    volatile char Byte = 0;
+    for(size_t n = Touched; n < Stop; n += 0x1000) Byte = Data[n];
+    (void)Byte;
+
+    Touched = Stop;
+    Watch.Split(Time);
+}
+//------------------------------------------------------------------------------
+
+bool READER::ReadLine(LINE& Line){
+    if(Data){
+        if(Position >= Length) return false;
+        if(Position >= Touched) Touch();
+
+        const char* Begin = Data + Position;
+        const char* Stop  = (const char*)memchr(Begin, '\n', Length - Position);
+
+        if(Stop){
+            Position = Stop - Data + 1;
+        }else{
+            Stop     = Data + Length;
+            Position = Length;
+        }
+        MakeLine(Begin, Stop - Begin, Line);
+        return true;
+    }
+
+    if(!Source) return false;
+
+    size_t Scanned = Start;
+    while(true){
+        const char* Stop = (const char*)memchr(Buffer + Scanned, '\n', End - Scanned);
+        if(Stop){
+            const char* Begin = Buffer + Start;
+            Start = Stop - Buffer + 1;
+            MakeLine(Begin, Stop - Begin, Line);
+            return true;
+        }
+        Scanned = End - Start;
+        if(!Fill()) break;
+        Scanned += Start;
+    }
+
+    // Last line without a terminator
+    if(Start == End) return false;
+    MakeLine(Buffer + Start, End - Start, Line);
+    Start = End;
+    return true;
+}
+//------------------------------------------------------------------------------
+
+bool READER::GetData(const char** Data, size_t* Length, size_t* Offset) const{
+    if(!this->Data) return false;
+
+    *Data   = this->Data;
+    *Length = this->Length;
+    *Offset = Position;
+    return true;
+}
+//------------------------------------------------------------------------------
+
+bool READER::IsCompressed() const{
+    return Gzip && Gzip->IsCompressed();
+}
+//------------------------------------------------------------------------------
+
+bool READER::Failed() const{
+    return Gzip && Gzip->Failed;
+}
+//------------------------------------------------------------------------------
+
+long long READER::BytesRead() const{
+    if(Mapping   ) return MappingSize;
+    if(FileSource) return FileSource->Length;
+    if(Data      ) return Length;
+    return SourceLength;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,130 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Reader_h
+#define Reader_h
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include "Gzip.h"
+#include "Statistics.h"
+#include "Stream.h"
+//------------------------------------------------------------------------------
+
+// A view of one line of input, excluding the line terminator.  Indexing
+// beyond the end returns 0, so that the parser can scan up to the null
+// character as if the line was a C string.
+struct LINE{
+    const char* Data;
+    int         Length;
+
+    inline char operator[](int Index) const{
+        return (unsigned)Index < (unsigned)Length ? Data[Index] : 0;
+    }
+};
+//------------------------------------------------------------------------------
+
+// Splits the input into lines.  Files are memory mapped where possible and
+// other sources are read in large blocks.  The returned views point into the
+// mapping or the block buffer and remain valid until the next call to
+// ReadLine.  Lines can be of any length.  Gzip-compressed files are
+// decompressed while reading.
+//
+// Mapped files are faulted in a block at a time ahead of the lines, so that
+// waiting for the disk is timed as reading, like filling a block.
+class READER{
+    private:
+        // Memory mapped file
+        void*  Mapping;
+        size_t MappingSize;
+        #ifdef _WIN32
+            void* FileHandle;
+            void* MappingHandle;
+        #endif
+
+        // File that could not be mapped
+        FILE*        File;
+        FILE_SOURCE* FileSource;
+
+        // Decompression of a compressed file, from the mapping or the file
+        MEMORY_SOURCE* MappingSource;
+        GZIP_SOURCE*   Gzip;
+
+        // The whole input, for memory buffers and mapped files
+        const char* Data;
+        size_t      Length;
+        size_t      Position;
+        size_t      Touched; // Bytes faulted in
+
+        // Bytes read from the source, for sources other than files
+        long long SourceLength;
+
+        // Block reading
+        SOURCE* Source;
+        char*   Buffer;
+        size_t  BufferSize;
+        size_t  Start, End;
+        bool    EndOfInput;
+
+        // Lines with embedded carriage returns are copied here
+        std::string Scratch;
+
+        void OpenMapping();
+        void MakeLine   (const char* Data, size_t Length, LINE& Line);
+        bool Fill       ();
+        void Touch      ();
+
+    public:
+        // Spent reading, over all the inputs opened
+        PHASE_TIME Time;
+
+        READER();
+       ~READER();
+
+        bool Open (const char* Filename);
+        void Open (FILE* File); // Such as stdin; not closed
+        void Open (const char* Data, size_t Length);
+        void Open (SOURCE* Source);
+        void Close();
+
+        // Returns false at the end of the input
+        bool ReadLine(LINE& Line);
+
+        // For memory buffers and mapped files: the whole input, and the
+        // offset of the next line.  Returns false for block reading.
+        bool GetData(const char** Data, size_t* Length, size_t* Offset) const;
+
+        // Whether the file opened is gzip-compressed, and whether the
+        // compressed data was found to be corrupt or truncated
+        bool IsCompressed() const;
+        bool Failed      () const;
+
+        // The bytes taken from the file, pipe or buffer so far, before
+        // decompression.  Mapped files and buffers count in full.
+        long long BytesRead() const;
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
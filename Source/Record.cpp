@@ -0,0 +1,201 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Record.h"
+//------------------------------------------------------------------------------
+
+RECORDER::RECORDER(size_t Size){
+    Buffer   = (char*)malloc(Size);
+    Position = Buffer;
+    Limit    = Buffer + Size;
+}
+//------------------------------------------------------------------------------
+
+RECORDER::~RECORDER(){
+    free(Buffer);
+}
+//------------------------------------------------------------------------------
+
+void RECORDER::Overflow(size_t Size){
+    size_t Used     = Position - Buffer;
+    size_t Capacity = 2 * (Limit - Buffer);
+    if(Capacity < Used + Size) Capacity = Used + Size;
+
+    char* New = (char*)realloc(Buffer, Capacity);
+    if(!New) throw std::bad_alloc();
+
+    Buffer   = New;
+    Position = Buffer + Used;
+    Limit    = Buffer + Capacity;
+}
+//------------------------------------------------------------------------------
+
+void RECORDER::Format(bool Metric, int IntDigits, int FractionDigits){
+    Reserve(1 + 3*sizeof(int));
+    Put(Record_Format); Put((int)Metric); Put(IntDigits); Put(FractionDigits);
+}
+//------------------------------------------------------------------------------
+
+void RECORDER::Aperture(int Code, const char* Diameter, int Length){
+    Reserve(1 + 2*sizeof(int) + Length);
+    Put(Record_Aperture); Put(Code); Put(Length);
+    memcpy(Position, Diameter, Length);
+    Position += Length;
+}
+//------------------------------------------------------------------------------
+
+void RECORDER::Begin(){
+    Reserve(1);
+    Put(Record_Begin);
+}
+//------------------------------------------------------------------------------
+
+void RECORDER::End(){
+    Reserve(1);
+    Put(Record_End);
+}
+//------------------------------------------------------------------------------
+
+void RECORDER::Linear(){
+    Reserve(1);
+    Put(Record_Linear);
+}
+//------------------------------------------------------------------------------
+
+void RECORDER::Circular(bool CCW){
+    Reserve(1 + sizeof(int));
+    Put(Record_Circular); Put((int)CCW);
+}
+//------------------------------------------------------------------------------
+
+void RECORDER::Arc(int X, int Y, int I, int J){
+    Reserve(1 + 4*sizeof(int));
+    Put(Record_Arc); Put(X); Put(Y); Put(I); Put(J);
+}
+//------------------------------------------------------------------------------
+
+void RECORDER::Circle(int X, int Y, int R){
+    Reserve(1 + 3*sizeof(int));
+    Put(Record_Circle); Put(X); Put(Y); Put(R);
+}
+//------------------------------------------------------------------------------
+
+void RECORDER::StepRepeat(int CountX, int CountY, int StepX, int StepY){
+    Reserve(1 + 4*sizeof(int));
+    Put(Record_StepRepeat); Put(CountX); Put(CountY); Put(StepX); Put(StepY);
+}
+//------------------------------------------------------------------------------
+
+void RECORDER::EndStepRepeat(){
+    Reserve(1);
+    Put(Record_EndStepRepeat);
+}
+//------------------------------------------------------------------------------
+
+bool RECORDER::Flush(){
+    return true;
+}
+//------------------------------------------------------------------------------
+
+static inline int Get(const char*& Data){
+    int Value;
+    memcpy(&Value, Data, sizeof(int));
+    Data += sizeof(int);
+    return Value;
+}
+//------------------------------------------------------------------------------
+
+void Replay(const char* Data, size_t Length, PLOTTER* Plotter){
+    const char* End = Data + Length;
+    int a, b, c, d;
+
+    while(Data < End){
+        switch(*Data++){
+            case Record_Format:
+                a = Get(Data); b = Get(Data); c = Get(Data);
+                Plotter->Format(a, b, c);
+                break;
+
+            case Record_Aperture:
+                a = Get(Data); b = Get(Data);
+                Plotter->Aperture(a, Data, b);
+                Data += b;
+                break;
+
+            case Record_Begin:
+                Plotter->Begin();
+                break;
+
+            case Record_End:
+                Plotter->End();
+                break;
+
+            case Record_Select:
+                Plotter->Select(Get(Data));
+                break;
+
+            case Record_Linear:
+                Plotter->Linear();
+                break;
+
+            case Record_Circular:
+                Plotter->Circular(Get(Data));
+                break;
+
+            case Record_Flash:
+                a = Get(Data); b = Get(Data);
+                Plotter->Flash(a, b);
+                break;
+
+            case Record_Move:
+                a = Get(Data); b = Get(Data);
+                Plotter->Move(a, b);
+                break;
+
+            case Record_Draw:
+                a = Get(Data); b = Get(Data);
+                Plotter->Draw(a, b);
+                break;
+
+            case Record_Arc:
+                a = Get(Data); b = Get(Data); c = Get(Data); d = Get(Data);
+                Plotter->Arc(a, b, c, d);
+                break;
+
+            case Record_Circle:
+                a = Get(Data); b = Get(Data); c = Get(Data);
+                Plotter->Circle(a, b, c);
+                break;
+
+            case Record_StepRepeat:
+                a = Get(Data); b = Get(Data); c = Get(Data); d = Get(Data);
+                Plotter->StepRepeat(a, b, c, d);
+                break;
+
+            case Record_EndStepRepeat:
+                Plotter->EndStepRepeat();
+                break;
+
+            default: // Corrupt data
+                return;
+        }
+    }
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,124 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Record_h
+#define Record_h
+//------------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+
+#include "Plotter.h"
+//------------------------------------------------------------------------------
+
+// Plotter operations in a compact binary form: a one-byte record type,
+// followed by the integer arguments in native byte order.  Apertures are
+// followed by the length and text of the diameter.
+enum RECORD{
+    Record_Format,        // Metric, IntDigits, FractionDigits
+    Record_Aperture,      // Code, Length, Diameter text
+    Record_Begin,
+    Record_End,
+    Record_Select,        // Code
+    Record_Linear,
+    Record_Circular,      // CCW
+    Record_Flash,         // X, Y
+    Record_Move,          // X, Y
+    Record_Draw,          // X, Y
+    Record_Arc,           // X, Y, I, J
+    Record_Circle,        // X, Y, R
+    Record_StepRepeat,    // CountX, CountY, StepX, StepY
+    Record_EndStepRepeat
+};
+//------------------------------------------------------------------------------
+
+// Records the operations in memory, to be replayed later or on another
+// thread.  The buffer grows as required; derived classes can pass full
+// buffers on instead.
+class RECORDER: public PLOTTER{
+    protected:
+        char* Buffer;
+        char* Position;
+        char* Limit;
+
+        // Makes room for at least Size more bytes
+        virtual void Overflow(size_t Size);
+
+    private:
+        inline void Reserve(size_t Size){
+            if((size_t)(Limit - Position) < Size) Overflow(Size);
+        }
+        inline void Put(RECORD Type){
+            *Position++ = (char)Type;
+        }
+        inline void Put(int Value){
+            memcpy(Position, &Value, sizeof(int));
+            Position += sizeof(int);
+        }
+
+    public:
+        RECORDER(size_t Size = 0x10000);
+       ~RECORDER();
+
+        inline const char* Data  () const{ return Buffer; }
+        inline size_t      Length() const{ return Position - Buffer; }
+        inline void        Clear ()      { Position = Buffer; }
+
+        void Format  (bool Metric, int IntDigits, int FractionDigits);
+        void Aperture(int Code, const char* Diameter, int Length);
+        void Begin   ();
+        void End     ();
+        void Linear  ();
+        void Circular(bool CCW);
+
+        inline void Select(int Code){
+            Reserve(1 + sizeof(int));
+            Put(Record_Select); Put(Code);
+        }
+        inline void Flash(int X, int Y){
+            Reserve(1 + 2*sizeof(int));
+            Put(Record_Flash); Put(X); Put(Y);
+        }
+        inline void Move(int X, int Y){
+            Reserve(1 + 2*sizeof(int));
+            Put(Record_Move); Put(X); Put(Y);
+        }
+        inline void Draw(int X, int Y){
+            Reserve(1 + 2*sizeof(int));
+            Put(Record_Draw); Put(X); Put(Y);
+        }
+
+        void Arc          (int X, int Y, int I, int J);
+        void Circle       (int X, int Y, int R);
+        void StepRepeat   (int CountX, int CountY, int StepX, int StepY);
+        void EndStepRepeat();
+
+        bool Flush();
+};
+//------------------------------------------------------------------------------
+
+// Passes recorded operations on to the plotter
+void Replay(const char* Data, size_t Length, PLOTTER* Plotter);
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
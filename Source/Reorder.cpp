@@ -0,0 +1,193 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Reorder.h"
+//------------------------------------------------------------------------------
+
+REORDER::REORDER(PLOTTER* Output): FILTER(Output){
+    Code       = 0;
+    OutputCode = INT_MIN;
+    InBlock    = false;
+    Started    = false;
+    LastX      = 0;
+    LastY      = 0;
+
+    HitsReordered = 0;
+    SelectsIn     = 0;
+    SelectsOut    = 0;
+    TravelIn      = 0;
+    TravelOut     = 0;
+
+    // The converter's default format, until it specifies one
+    Scale = 1e-3;
+}
+//------------------------------------------------------------------------------
+
+// The distance along a Hilbert curve that fills a 2^16 by 2^16 grid
+uint32_t REORDER::Hilbert(uint32_t X, uint32_t Y){
+    const uint32_t Size = 1 << 16;
+    uint32_t       d    = 0;
+
+    for(uint32_t s = Size/2; s; s >>= 1){
+        uint32_t rx = (X & s) ? 1 : 0;
+        uint32_t ry = (Y & s) ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+
+        // Rotates the quadrant, so that the curve is continuous
+        if(!ry){
+            if(rx){
+                X = Size-1 - X;
+                Y = Size-1 - Y;
+            }
+            uint32_t t = X; X = Y; Y = t;
+        }
+    }
+    return d;
+}
+//------------------------------------------------------------------------------
+
+// Sorts the hits so far and passes them on
+void REORDER::Drain(){
+    if(Hits.empty()) return;
+
+    int MinX = INT_MAX, MaxX = INT_MIN;
+    int MinY = INT_MAX, MaxY = INT_MIN;
+    for(size_t n = 0; n < Hits.size(); n++){
+        const HIT& Hit = Hits[n];
+        if(MinX > Hit.X) MinX = Hit.X;
+        if(MaxX < Hit.X) MaxX = Hit.X;
+        if(MinY > Hit.Y) MinY = Hit.Y;
+        if(MaxY < Hit.Y) MaxY = Hit.Y;
+    }
+    // The same scale on both axes, so that the curve does not stretch
+    uint64_t Span = (int64_t)MaxX - MinX;
+    if(Span < (uint64_t)((int64_t)MaxY - MinY)) Span = (int64_t)MaxY - MinY;
+    if(!Span) Span = 1;
+
+    for(size_t n = 0; n < Hits.size(); n++){
+        HIT& Hit = Hits[n];
+        uint32_t X = ((uint64_t)((int64_t)Hit.X - MinX) * 0xFFFF) / Span;
+        uint32_t Y = ((uint64_t)((int64_t)Hit.Y - MinY) * 0xFFFF) / Span;
+        Hit.Key |= Hilbert(X, Y);
+    }
+    std::sort(Hits.begin(), Hits.end());
+
+    for(size_t n = 0; n < Hits.size(); n++){
+        const HIT& Hit = Hits[n];
+
+        int HitCode = (int)(uint32_t)(Hit.Key >> 32);
+        if(OutputCode != HitCode){
+            Output->Select(HitCode);
+            OutputCode = HitCode;
+            SelectsOut++;
+        }
+        Output->Flash(Hit.X, Hit.Y);
+
+        if(n) TravelOut += Distance(Hits[n-1].X, Hits[n-1].Y, Hit.X, Hit.Y);
+    }
+    HitsReordered += Hits.size();
+
+    Hits.clear();
+    Hits.shrink_to_fit();
+}
+//------------------------------------------------------------------------------
+
+void REORDER::Format(bool Metric, int IntDigits, int FractionDigits){
+    Scale = pow(10.0, -FractionDigits);
+    if(!Metric) Scale *= 25.4;
+
+    Output->Format(Metric, IntDigits, FractionDigits);
+}
+//------------------------------------------------------------------------------
+
+void REORDER::End(){
+    Finish();
+    Output->End();
+}
+//------------------------------------------------------------------------------
+
+void REORDER::Select(int Code){
+    this->Code = Code;
+}
+//------------------------------------------------------------------------------
+
+void REORDER::Flash(int X, int Y){
+    if(InBlock){
+        Sync();
+        Output->Flash(X, Y);
+        return;
+    }
+
+    HIT Hit;
+    Hit.Key = (uint64_t)(uint32_t)Code << 32;
+    Hit.X   = X;
+    Hit.Y   = Y;
+
+    if(Hits.empty() || Hits.back().Key != Hit.Key) SelectsIn++;
+    if(Started) TravelIn += Distance(LastX, LastY, X, Y);
+
+    Started = true;
+    LastX   = X;
+    LastY   = Y;
+
+    Hits.push_back(Hit);
+}
+//------------------------------------------------------------------------------
+
+void REORDER::Move(int X, int Y){
+    Sync();
+    Output->Move(X, Y);
+}
+//------------------------------------------------------------------------------
+
+void REORDER::Draw(int X, int Y){
+    Sync();
+    Output->Draw(X, Y);
+}
+//------------------------------------------------------------------------------
+
+void REORDER::Arc(int X, int Y, int I, int J){
+    Sync();
+    Output->Arc(X, Y, I, J);
+}
+//------------------------------------------------------------------------------
+
+void REORDER::Circle(int X, int Y, int R){
+    Sync();
+    Output->Circle(X, Y, R);
+}
+//------------------------------------------------------------------------------
+
+void REORDER::StepRepeat(int CountX, int CountY, int StepX, int StepY){
+    InBlock = true;
+    Output->StepRepeat(CountX, CountY, StepX, StepY);
+}
+//------------------------------------------------------------------------------
+
+void REORDER::EndStepRepeat(){
+    InBlock = false;
+    Output->EndStepRepeat();
+}
+//------------------------------------------------------------------------------
+
+void REORDER::Finish(){
+    Drain();
+}
+//------------------------------------------------------------------------------
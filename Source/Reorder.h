@@ -0,0 +1,114 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Reorder_h
+#define Reorder_h
+//------------------------------------------------------------------------------
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Filter.h"
+//------------------------------------------------------------------------------
+
+// Holds the drill hits (flashes) back until the end, then passes them on
+// grouped by aperture, and within every aperture in the order of a Hilbert
+// curve over the bounding box of all the hits.  Consecutive hits are then
+// close together, and every aperture is only selected once.  This takes
+// O(n log n) time and 16 bytes per hit.
+//
+// Routes and the flashes inside step-and-repeat blocks are passed on in
+// their original order, ahead of the hits.
+class REORDER: public FILTER{
+    private:
+        struct HIT{
+            uint64_t Key; // Aperture code, then position on the curve
+            int      X, Y;
+
+            inline bool operator< (const HIT& Hit) const{
+                return Key < Hit.Key;
+            }
+        };
+
+        std::vector<HIT> Hits;
+
+        double Scale; // mm per file unit
+
+        int  Code;       // Selected in the input ...
+        int  OutputCode; // ... and in the output; INT_MIN when unknown
+        bool InBlock;
+
+        // The last hit in the input, for the travel distance
+        bool Started;
+        int  LastX, LastY;
+
+        inline void Sync(){
+            if(OutputCode != Code){
+                Output->Select(Code);
+                OutputCode = Code;
+            }
+        }
+
+        // In mm
+        inline double Distance(int X1, int Y1, int X2, int Y2) const{
+            double dX = (double)X2 - X1;
+            double dY = (double)Y2 - Y1;
+            return Scale * sqrt(dX*dX + dY*dY);
+        }
+
+        static uint32_t Hilbert(uint32_t X, uint32_t Y);
+
+        void Drain();
+
+    public:
+        long long HitsReordered;
+        long long SelectsIn;  // Aperture changes between hits in the input ...
+        long long SelectsOut; // ... and in the output
+
+        // Distance between consecutive hits, in mm
+        double TravelIn;
+        double TravelOut;
+
+        REORDER(PLOTTER* Output);
+
+        void Format       (bool Metric, int IntDigits, int FractionDigits);
+        void End          ();
+        void Select       (int Code);
+        void Flash        (int X, int Y);
+        void Move         (int X, int Y);
+        void Draw         (int X, int Y);
+        void Arc          (int X, int Y, int I, int J);
+        void Circle       (int X, int Y, int R);
+        void StepRepeat   (int CountX, int CountY, int StepX, int StepY);
+        void EndStepRepeat();
+
+        // Passes the held hits on, ordered, for an input that did not end.
+        // The hits are otherwise only passed on by End, as the order needs
+        // all of them.
+        void Finish();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
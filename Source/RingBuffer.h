@@ -0,0 +1,89 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef RingBuffer_h
+#define RingBuffer_h
+//------------------------------------------------------------------------------
+
+#include <stddef.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+//------------------------------------------------------------------------------
+
+// Bounded single-producer, single-consumer queue.  Exactly one thread may
+// push and exactly one other thread may pop.  There are no locks: a full or
+// empty queue is waited on by spinning briefly and then sleeping.  Size must
+// be a power of two.
+template<class ITEM, size_t Size> class RING_BUFFER{
+    private:
+        static_assert(Size && !(Size & (Size-1)), "Size must be a power of two");
+
+        ITEM Items[Size];
+
+        // On separate cache lines, as each is written by a different thread
+        alignas(64) std::atomic<size_t> Head; // Next item to pop
+        alignas(64) std::atomic<size_t> Tail; // Next item to push
+
+        static void Wait(int& Attempt){
+            if(++Attempt < 64){
+                std::this_thread::yield();
+            }else{
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+
+    public:
+        RING_BUFFER(): Head(0), Tail(0){}
+
+        bool TryPush(const ITEM& Item){
+            size_t t = Tail.load(std::memory_order_relaxed);
+            if(t - Head.load(std::memory_order_acquire) == Size) return false;
+            Items[t & (Size-1)] = Item;
+            Tail.store(t+1, std::memory_order_release);
+            return true;
+        }
+
+        bool TryPop(ITEM* Item){
+            size_t h = Head.load(std::memory_order_relaxed);
+            if(h == Tail.load(std::memory_order_acquire)) return false;
+            *Item = Items[h & (Size-1)];
+            Head.store(h+1, std::memory_order_release);
+            return true;
+        }
+
+        // Block while the queue is full or empty
+        void Push(const ITEM& Item){
+            int Attempt = 0;
+            while(!TryPush(Item)) Wait(Attempt);
+        }
+
+        ITEM Pop(){
+            ITEM Item;
+            int  Attempt = 0;
+            while(!TryPop(&Item)) Wait(Attempt);
+            return Item;
+        }
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
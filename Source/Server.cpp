@@ -0,0 +1,731 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Server.h"
+
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include <thread>
+#include <vector>
+
+#include "Converter.h"
+#include "Dedupe.h"
+#include "Reorder.h"
+#include "Simplify.h"
+//------------------------------------------------------------------------------
+
+using namespace PROTOCOL;
+
+typedef std::chrono::steady_clock CLOCK;
+//------------------------------------------------------------------------------
+
+static inline void Put32(char* Buffer, uint32_t Value){
+    Buffer[0] = (char)(Value      );
+    Buffer[1] = (char)(Value >>  8);
+    Buffer[2] = (char)(Value >> 16);
+    Buffer[3] = (char)(Value >> 24);
+}
+//------------------------------------------------------------------------------
+
+static inline uint32_t Get32(const char* Buffer){
+    const unsigned char* Bytes = (const unsigned char*)Buffer;
+    return (uint32_t)Bytes[0]       | (uint32_t)Bytes[1] <<  8 |
+           (uint32_t)Bytes[2] << 16 | (uint32_t)Bytes[3] << 24;
+}
+//------------------------------------------------------------------------------
+
+// Returns the number of bytes read, which is less than the length only at the
+// end of the input, or -1 on failure
+static long long ReadFully(int Handle, char* Buffer, size_t Length){
+    size_t Total = 0;
+    while(Total < Length){
+        long long Count = read(Handle, Buffer + Total, Length - Total);
+        if(Count < 0 && errno == EINTR) continue;
+        if(Count < 0) return -1;
+        if(Count == 0) break;
+        Total += Count;
+    }
+    return Total;
+}
+//------------------------------------------------------------------------------
+
+// As above, but fails with ETIMEDOUT once the deadline has passed, however
+// slowly the data trickles in
+static long long ReadFully(int Handle, char* Buffer, size_t Length, CLOCK::time_point Deadline){
+    size_t Total = 0;
+    while(Total < Length){
+        auto Remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            Deadline - CLOCK::now()).count();
+        if(Remaining <= 0){
+            errno = ETIMEDOUT;
+            return -1;
+        }
+
+        pollfd Poll;
+        Poll.fd     = Handle;
+        Poll.events = POLLIN;
+        int Ready = poll(&Poll, 1, (int)Remaining);
+        if(Ready < 0 && errno == EINTR) continue;
+        if(Ready < 0) return -1;
+        if(Ready == 0) continue; // The deadline is checked above
+
+        long long Count = read(Handle, Buffer + Total, Length - Total);
+        if(Count < 0 && errno == EINTR) continue;
+        if(Count < 0) return -1;
+        if(Count == 0) break;
+        Total += Count;
+    }
+    return Total;
+}
+//------------------------------------------------------------------------------
+
+// Ends the input once more than the limit has been read
+class LIMITED_SOURCE: public SOURCE{
+    private:
+        SOURCE* Source;
+        size_t  Remaining;
+
+    public:
+        bool Exceeded;
+
+        LIMITED_SOURCE(SOURCE* Source, size_t Limit){
+            this->Source = Source;
+            Remaining    = Limit;
+            Exceeded     = false;
+        }
+
+        size_t Read(char* Buffer, size_t Size){
+            if(Exceeded) return 0;
+
+            size_t Count = Source->Read(Buffer, Size);
+            if(Count > Remaining){
+                Exceeded = true;
+                return 0;
+            }
+            Remaining -= Count;
+            return Count;
+        }
+};
+//------------------------------------------------------------------------------
+
+// Keeps the output in memory, and fails writes beyond the limit
+class LIMITED_SINK: public SINK{
+    private:
+        size_t Limit;
+
+    public:
+        std::string Data;
+        bool        Exceeded;
+
+        LIMITED_SINK(size_t Limit){
+            this->Limit = Limit;
+            Exceeded    = false;
+        }
+
+        bool Write(const char* Data, size_t Length){
+            if(Exceeded || this->Data.length() + Length > Limit){
+                Exceeded = true;
+                return false;
+            }
+            this->Data.append(Data, Length);
+            return true;
+        }
+};
+//------------------------------------------------------------------------------
+
+static bool WriteFully(int Handle, const char* Buffer, size_t Length){
+    size_t Total = 0;
+    while(Total < Length){
+        long long Count = write(Handle, Buffer + Total, Length - Total);
+        if(Count < 0 && errno == EINTR) continue;
+        if(Count <= 0) return false;
+        Total += Count;
+    }
+    return true;
+}
+//------------------------------------------------------------------------------
+
+static bool WriteResponse(int Handle, const RESPONSE& Response){
+    char Header[16];
+    memcpy(Header, "D2GR", 4);
+    Put32(Header +  4, Response.Status);
+    Put32(Header +  8, Response.Output.length());
+    Put32(Header + 12, Response.Log.length());
+
+    return WriteFully(Handle, Header, sizeof(Header)) &&
+           WriteFully(Handle, Response.Output.data(), Response.Output.length()) &&
+           WriteFully(Handle, Response.Log   .data(), Response.Log   .length());
+}
+//------------------------------------------------------------------------------
+
+static long long Microseconds(CLOCK::duration Duration){
+    return std::chrono::duration_cast<std::chrono::microseconds>(Duration).count();
+}
+//------------------------------------------------------------------------------
+
+LATENCY::LATENCY(){
+    for(auto& Bucket: Buckets) Bucket = 0;
+}
+//------------------------------------------------------------------------------
+
+void LATENCY::Add(long long Microseconds){
+    if(Microseconds < 4) Microseconds = 4;
+
+    int Exponent = 0;
+    while(Microseconds >> (Exponent+1)) Exponent++;
+
+    int Index = 4*Exponent + ((Microseconds >> (Exponent-2)) & 3);
+    if(Index > 159) Index = 159;
+    Buckets[Index]++;
+}
+//------------------------------------------------------------------------------
+
+long long LATENCY::Count() const{
+    long long Total = 0;
+    for(auto& Bucket: Buckets) Total += Bucket;
+    return Total;
+}
+//------------------------------------------------------------------------------
+
+double LATENCY::Percentile(double Fraction) const{
+    long long Total = Count();
+    if(!Total) return 0;
+
+    long long Target = (long long)ceil(Fraction * Total);
+    if(Target < 1) Target = 1;
+
+    long long Sum = 0;
+    for(int n = 0; n < 160; n++){
+        Sum += Buckets[n];
+        // The upper bound of the bucket
+        if(Sum >= Target) return ldexp((n & 3) + 5, n/4 - 2) / 1e3;
+    }
+    return 0;
+}
+//------------------------------------------------------------------------------
+
+SERVER::COUNTERS::COUNTERS(){
+    Requests = 0;
+    Failed   = 0;
+    Rejected = 0;
+    TimedOut = 0;
+    BytesIn  = 0;
+    BytesOut = 0;
+}
+//------------------------------------------------------------------------------
+
+SERVER::SERVER(int Threads, const LIMITS& Limits): Pool(Threads){
+    this->Limits = Limits;
+    if(this->Limits.MaxQueued <= 0) this->Limits.MaxQueued = 2*Pool.Size();
+    if(this->Limits.MaxOutput == 0) this->Limits.MaxOutput = 4*this->Limits.MaxInput;
+
+    Listener = -1;
+    Stopping = false;
+    Queued   = 0;
+    Clients  = 0;
+    Started  = CLOCK::now();
+
+    // Disconnected clients are reported by write, rather than a signal
+    signal(SIGPIPE, SIG_IGN);
+}
+//------------------------------------------------------------------------------
+
+SERVER::~SERVER(){
+    if(Listener >= 0){
+        close(Listener);
+        unlink(Path.c_str());
+    }
+}
+//------------------------------------------------------------------------------
+
+bool SERVER::Acquire(CLOCK::time_point Deadline){
+    std::unique_lock<std::mutex> Lock(Mutex);
+
+    if(!Signal.wait_until(Lock, Deadline, [this]{ return Queued < Limits.MaxQueued; })){
+        return false;
+    }
+    Queued++;
+    return true;
+}
+//------------------------------------------------------------------------------
+
+void SERVER::Release(){
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Queued--;
+    Signal.notify_all();
+}
+//------------------------------------------------------------------------------
+
+void SERVER::Convert(
+    const std::string& Input,
+    uint32_t           Flags,
+    CLOCK::time_point  Deadline,
+    RESPONSE&          Response
+){
+    Response.Status = Status_Timeout;
+    Response.Log    = "Error: Time limit exceeded\n";
+    if(CLOCK::now() > Deadline) return;
+
+    LIMITED_SINK  Sink(Limits.MaxOutput);
+    GERBER_WRITER Gerber;
+    Gerber.Open(&Sink);
+
+    PLOTTER* Plotter = &Gerber;
+    REORDER  Reorder(Plotter);
+    if(Flags & Flag_Reorder) Plotter = &Reorder;
+    SIMPLIFY Simplify(Plotter, 0);
+    if(Flags & Flag_Simplify) Plotter = &Simplify;
+    DEDUPE   Dedupe(Plotter, 0);
+    if(Flags & Flag_Dedupe) Plotter = &Dedupe;
+
+    CONVERTER Converter;
+    Converter.Options.StepRepeat = Flags & Flag_StepRepeat;
+    Converter.Begin(Plotter);
+
+    // Compressed input is passed through unchanged otherwise.  The size
+    // limit also applies after decompression, so that a small compressed
+    // request cannot expand without bound.
+    MEMORY_SOURCE  Memory(Input.data(), Input.length());
+    GZIP_SOURCE    Gzip(&Memory);
+    LIMITED_SOURCE Limited(&Gzip, Limits.MaxInput);
+
+    READER Reader;
+    Reader.Open(&Limited);
+
+    // The deadline and the output size are checked every few thousand lines,
+    // which is frequent enough and does not slow the conversion down
+    LINE      Line;
+    long long Count = 0;
+    while(Reader.ReadLine(Line)){
+        Converter.Convert(Line);
+        if(!(++Count & 0xFFF)){
+            if(CLOCK::now() > Deadline) return;
+            if(Sink.Exceeded) break;
+        }
+    }
+    bool Success = Converter.End();
+
+    // Passes the hits on if the input did not end
+    if(Flags & Flag_Reorder){
+        Reorder.Finish();
+        if(!Reorder.Flush()) Success = false;
+    }
+
+    if(Limited.Exceeded || Sink.Exceeded){
+        Response.Status = Status_TooLarge;
+        Response.Log    = Limited.Exceeded ?
+            "Error: The decompressed input exceeds the size limit\n" :
+            "Error: The output exceeds the size limit\n";
+        return;
+    }
+
+    Response.Log.clear();
+    if(Gzip.Failed){
+        Response.Log += "Error: The compressed input is corrupt or truncated\n";
+        Success = false;
+    }
+
+    char Buffer[0x40];
+    for(auto& Diagnostic: Converter.Diagnostics){
+        if(Diagnostic.Level == DIAGNOSTIC::Error) Response.Log += "Error";
+        else                                      Response.Log += "Warning";
+
+        if(Diagnostic.LineNumber){
+            sprintf(Buffer, " on line %d", Diagnostic.LineNumber);
+            Response.Log += Buffer;
+        }
+        Response.Log += ": " + Diagnostic.Message + "\n";
+    }
+    Response.Status = Success ? Status_Success : Status_Failed;
+    Response.Output.swap(Sink.Data);
+}
+//------------------------------------------------------------------------------
+
+bool SERVER::Handle(int Input, int Output){
+    char Header[12];
+    if(ReadFully(Input, Header, sizeof(Header)) != sizeof(Header)) return false;
+
+    auto Start    = CLOCK::now();
+    auto Deadline = Start + std::chrono::milliseconds(Limits.TimeLimit);
+
+    uint32_t Flags  = Get32(Header + 4);
+    uint32_t Length = Get32(Header + 8);
+
+    RESPONSE Response;
+    Response.Status = Status_Success;
+
+    if(memcmp(Header, "D2GQ", 4)){
+        Counters.Requests++;
+        Counters.Rejected++;
+        Counters.Failed  ++;
+        Response.Status = Status_Invalid;
+        Response.Log    = "Error: Not a conversion request\n";
+        WriteResponse(Output, Response);
+        return false;
+    }
+
+    if(Flags & Flag_Counters){
+        Response.Log = GetCounters();
+        return WriteResponse(Output, Response);
+    }
+
+    Counters.Requests++;
+
+    // The rest of the request is not read, so the connection cannot be used
+    // any further
+    if(Length > Limits.MaxInput){
+        Counters.Rejected++;
+        Counters.Failed  ++;
+        Response.Status = Status_TooLarge;
+        Response.Log    = "Error: The input exceeds the size limit\n";
+        WriteResponse(Output, Response);
+        return false;
+    }
+
+    // Waits for a slot before reading the input, so that queued requests do
+    // not hold their input in memory
+    if(!Acquire(Deadline)){
+        Counters.TimedOut++;
+        Counters.Failed  ++;
+        Response.Status = Status_Timeout;
+        Response.Log    = "Error: Time limit exceeded\n";
+        WriteResponse(Output, Response);
+        return false;
+    }
+
+    // A client that sends the input slowly only holds its slot until the
+    // deadline
+    std::string Data(Length, 0);
+    if(ReadFully(Input, &Data[0], Length, Deadline) != Length){
+        bool TimedOut = errno == ETIMEDOUT;
+        Release();
+        Counters.Failed++;
+        if(TimedOut){
+            Counters.TimedOut++;
+            Response.Status = Status_Timeout;
+            Response.Log    = "Error: Time limit exceeded\n";
+            WriteResponse(Output, Response);
+        }
+        return false;
+    }
+    Counters.BytesIn += Length + sizeof(Header);
+
+    std::mutex              DoneMutex;
+    std::condition_variable DoneSignal;
+    bool                    Done = false;
+
+    Pool.Add([&]{
+        Convert(Data, Flags, Deadline, Response);
+
+        std::lock_guard<std::mutex> Lock(DoneMutex);
+        Done = true;
+        DoneSignal.notify_one();
+    });{
+        std::unique_lock<std::mutex> Lock(DoneMutex);
+        DoneSignal.wait(Lock, [&]{ return Done; });
+    }
+    Release();
+
+    if(Response.Status == Status_Timeout) Counters.TimedOut++;
+    if(Response.Status != Status_Success) Counters.Failed  ++;
+
+    bool Result = WriteResponse(Output, Response);
+
+    Counters.BytesOut += 16 + Response.Output.length() + Response.Log.length();
+    Counters.Latency.Add(Microseconds(CLOCK::now() - Start));
+
+    return Result;
+}
+//------------------------------------------------------------------------------
+
+void SERVER::Serve(int Input, int Output){
+    while(Handle(Input, Output));
+}
+//------------------------------------------------------------------------------
+
+std::string SERVER::GetCounters(){
+    double Time = Microseconds(CLOCK::now() - Started) / 1e6;
+    if(Time <= 0) Time = 1e-6;
+
+    long long Requests = Counters.Requests;
+    double    In       = Counters.BytesIn  / 1e6;
+    double    Out      = Counters.BytesOut / 1e6;
+
+    int Queued, Clients;{
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Queued  = this->Queued;
+        Clients = this->Clients;
+    }
+
+    char Buffer[0x400];
+    sprintf(Buffer,
+        "Uptime:   %.1f s\n"
+        "Requests: %lld (%.1f/s), %lld failed, %lld rejected, %lld timed out\n"
+        "In:       %.3f MB (%.3f MB/s)\n"
+        "Out:      %.3f MB (%.3f MB/s)\n"
+        "Latency:  p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n"
+        "Queued:   %d of %d, %d clients connected\n",
+        Time,
+        Requests, Requests / Time,
+        (long long)Counters.Failed, (long long)Counters.Rejected,
+        (long long)Counters.TimedOut,
+        In,  In  / Time,
+        Out, Out / Time,
+        Counters.Latency.Percentile(0.50), Counters.Latency.Percentile(0.90),
+        Counters.Latency.Percentile(0.99), Counters.Latency.Percentile(1.00),
+        Queued, Limits.MaxQueued, Clients
+    );
+    return Buffer;
+}
+//------------------------------------------------------------------------------
+
+static bool GetAddress(const char* Path, sockaddr_un* Address){
+    if(strlen(Path) >= sizeof(Address->sun_path)){
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    memset(Address, 0, sizeof(sockaddr_un));
+    Address->sun_family = AF_UNIX;
+    strcpy(Address->sun_path, Path);
+    return true;
+}
+//------------------------------------------------------------------------------
+
+bool SERVER::Listen(const char* Path){
+    sockaddr_un Address;
+    if(!GetAddress(Path, &Address)) return false;
+
+    int Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(Socket < 0) return false;
+
+    // A socket left behind by a server that is no longer running is removed,
+    // but one that is in use is not
+    if(connect(Socket, (sockaddr*)&Address, sizeof(Address)) == 0){
+        close(Socket);
+        errno = EADDRINUSE;
+        return false;
+    }
+    if(errno == ECONNREFUSED) unlink(Path);
+    close(Socket);
+
+    Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(Socket < 0) return false;
+
+    if(bind(Socket, (sockaddr*)&Address, sizeof(Address)) || listen(Socket, 64)){
+        int Error = errno;
+        close(Socket);
+        errno = Error;
+        return false;
+    }
+    Listener   = Socket;
+    this->Path = Path;
+    return true;
+}
+//------------------------------------------------------------------------------
+
+void SERVER::Client(int Socket){
+    // Also disconnects clients that stay idle for longer than the limit
+    timeval Timeout;
+    Timeout.tv_sec  =  Limits.TimeLimit / 1000;
+    Timeout.tv_usec = (Limits.TimeLimit % 1000) * 1000;
+    setsockopt(Socket, SOL_SOCKET, SO_RCVTIMEO, &Timeout, sizeof(Timeout));
+    setsockopt(Socket, SOL_SOCKET, SO_SNDTIMEO, &Timeout, sizeof(Timeout));
+
+    while(!Stopping && Handle(Socket, Socket));
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    close(Socket);
+    Sockets.erase(Socket);
+    Clients--;
+    Signal.notify_all();
+}
+//------------------------------------------------------------------------------
+
+void SERVER::Run(){
+    auto Poll = std::chrono::milliseconds(100);
+
+    while(!Stopping){{
+            std::unique_lock<std::mutex> Lock(Mutex);
+            while(!Stopping && Clients >= Limits.MaxClients) Signal.wait_for(Lock, Poll);
+        }
+        if(Stopping) break;
+
+        int Socket = accept(Listener, 0, 0);
+        if(Socket < 0){
+            if(errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Clients++;
+        Sockets.insert(Socket);
+        std::thread(&SERVER::Client, this, Socket).detach();
+    }
+
+    // Requests being converted are still answered, but no more are read
+    std::unique_lock<std::mutex> Lock(Mutex);
+    for(int Socket: Sockets) shutdown(Socket, SHUT_RD);
+    while(Clients) Signal.wait_for(Lock, Poll);
+}
+//------------------------------------------------------------------------------
+
+void SERVER::Stop(){
+    Stopping = true;
+    if(Listener >= 0) shutdown(Listener, SHUT_RDWR);
+}
+//------------------------------------------------------------------------------
+
+CLIENT::CLIENT(){
+    Socket = -1;
+}
+//------------------------------------------------------------------------------
+
+CLIENT::~CLIENT(){
+    Close();
+}
+//------------------------------------------------------------------------------
+
+bool CLIENT::Connect(const char* Path){
+    Close();
+
+    sockaddr_un Address;
+    if(!GetAddress(Path, &Address)) return false;
+
+    Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(Socket < 0) return false;
+
+    if(connect(Socket, (sockaddr*)&Address, sizeof(Address))){
+        int Error = errno;
+        Close();
+        errno = Error;
+        return false;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    return true;
+}
+//------------------------------------------------------------------------------
+
+void CLIENT::Close(){
+    if(Socket >= 0) close(Socket);
+    Socket = -1;
+}
+//------------------------------------------------------------------------------
+
+bool CLIENT::Convert(
+    const char* Data,
+    size_t      Length,
+    uint32_t    Flags,
+    RESPONSE&   Response
+){
+    char Header[16];
+    memcpy(Header, "D2GQ", 4);
+    Put32(Header + 4, Flags);
+    Put32(Header + 8, Length);
+
+    // The server may refuse the request before reading the input
+    bool Sent = WriteFully(Socket, Header, 12) && WriteFully(Socket, Data, Length);
+
+    if(ReadFully(Socket, Header, 16) != 16 || memcmp(Header, "D2GR", 4)) return false;
+
+    Response.Status = Get32(Header + 4);
+    Response.Output.resize(Get32(Header +  8));
+    Response.Log   .resize(Get32(Header + 12));
+
+    if(ReadFully(Socket, &Response.Output[0], Response.Output.length()) != (long long)Response.Output.length() ||
+       ReadFully(Socket, &Response.Log   [0], Response.Log   .length()) != (long long)Response.Log   .length()){
+        return false;
+    }
+    return Sent || Response.Status != Status_Success;
+}
+//------------------------------------------------------------------------------
+
+bool LoadTest(
+    const char*  Path,
+    const char*  Data,
+    size_t       Length,
+    uint32_t     Flags,
+    int          Connections,
+    long long    Requests,
+    std::string& Report
+){
+    LATENCY                Latency;
+    std::atomic<long long> Next    (0);
+    std::atomic<long long> Failed  (0);
+    std::atomic<long long> BytesOut(0);
+    std::atomic<bool>      Broken  (false);
+
+    if(Connections < 1) Connections = 1;
+
+    auto Start = CLOCK::now();
+
+    std::vector<std::thread> Threads;
+    for(int n = 0; n < Connections; n++){
+        Threads.emplace_back([&]{
+            CLIENT Client;
+            if(!Client.Connect(Path)){
+                Broken = true;
+                return;
+            }
+            RESPONSE Response;
+            while(Next++ < Requests){
+                auto Sent = CLOCK::now();
+                if(!Client.Convert(Data, Length, Flags, Response)){
+                    Broken = true;
+                    return;
+                }
+                Latency.Add(Microseconds(CLOCK::now() - Sent));
+                if(Response.Status != Status_Success) Failed++;
+                BytesOut += Response.Output.length();
+            }
+        });
+    }
+    for(auto& Thread: Threads) Thread.join();
+
+    double    Time = Microseconds(CLOCK::now() - Start) / 1e6;
+    long long Done = Latency.Count();
+    if(Time <= 0) Time = 1e-6;
+
+    char Buffer[0x400];
+    sprintf(Buffer,
+        "Sent %lld requests over %d connections in %.3f s\n"
+        "Throughput: %.1f requests/s, %.3f MB/s in, %.3f MB/s out\n"
+        "Latency:    p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n"
+        "Failed:     %lld\n",
+        Done, Connections, Time,
+        Done / Time, Done * (double)Length / Time / 1e6, BytesOut / Time / 1e6,
+        Latency.Percentile(0.50), Latency.Percentile(0.90),
+        Latency.Percentile(0.99), Latency.Percentile(1.00),
+        (long long)Failed
+    );
+    Report = Buffer;
+
+    return !Broken;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,217 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Server_h
+#define Server_h
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "ThreadPool.h"
+//------------------------------------------------------------------------------
+
+// Framing of the conversion requests and responses.  All numbers are 32-bit
+// little-endian.
+//
+//   Request:  "D2GQ", Flags, Input length, input
+//   Response: "D2GR", Status, Output length, Log length, output, log
+//
+// The output is the Gerber file and the log lists the diagnostics, one per
+// line.  A request with Flag_Counters returns the server counters in the log
+// instead of converting.
+namespace PROTOCOL{
+    enum FLAGS{
+        Flag_StepRepeat = 0x01,
+        Flag_Dedupe     = 0x02,
+        Flag_Simplify   = 0x04,
+        Flag_Reorder    = 0x08,
+        Flag_Counters   = 0x80
+    };
+
+    enum STATUS{
+        Status_Success,
+        Status_Failed,   // The input could not be converted
+        Status_TooLarge, // The input or output exceeds its size limit
+        Status_Timeout,  // The conversion exceeds the time limit
+        Status_Invalid   // Not a request
+    };
+
+    struct RESPONSE{
+        uint32_t    Status;
+        std::string Output;
+        std::string Log;
+    };
+}
+//------------------------------------------------------------------------------
+
+// Histogram of latencies, with four buckets per power of two microseconds, so
+// that the percentiles are within 25%.  Safe to add to from any thread.
+struct LATENCY{
+    std::atomic<long long> Buckets[160];
+
+    LATENCY();
+
+    void      Add       (long long Microseconds);
+    long long Count     () const;
+    double    Percentile(double Fraction) const; // Milliseconds
+};
+//------------------------------------------------------------------------------
+
+// Converts drill files sent over a Unix domain socket, or framed on a pair of
+// file descriptors, such as stdin and stdout.
+//
+// Every connection has its own thread for reading and writing, while the
+// conversions run on the thread pool.  At most MaxQueued requests are queued
+// or converted at a time: further connections wait in the listen backlog and
+// further requests in their socket buffers, so that clients are slowed down
+// rather than memory growing without bound.
+//
+// The server and client use Unix domain sockets and poll, so they are not
+// built on Windows.  Only the limits are defined there, for the settings.
+class SERVER{
+    public:
+        struct LIMITS{
+            size_t MaxInput;   // Bytes, before and after decompression
+            size_t MaxOutput;  // Bytes; 0 for four times MaxInput
+            int    TimeLimit;  // Milliseconds per request, including the queue
+            int    MaxQueued;  // Requests
+            int    MaxClients; // Connections
+
+            LIMITS(){
+                MaxInput   = 64 << 20;
+                MaxOutput  = 0;
+                TimeLimit  = 30000;
+                MaxQueued  = 0;
+                MaxClients = 256;
+            }
+        };
+
+        struct COUNTERS{
+            std::atomic<long long> Requests;
+            std::atomic<long long> Failed;   // Of any status but success
+            std::atomic<long long> Rejected; // Too large or invalid
+            std::atomic<long long> TimedOut;
+            std::atomic<long long> BytesIn;
+            std::atomic<long long> BytesOut;
+
+            LATENCY Latency;
+
+            COUNTERS();
+        };
+
+    private:
+        LIMITS      Limits;
+        THREAD_POOL Pool;
+
+        int         Listener;
+        std::string Path;
+
+        std::atomic<bool> Stopping;
+
+        std::mutex              Mutex;
+        std::condition_variable Signal; // A slot or client was released
+        int                     Queued;
+        int                     Clients;
+        std::set<int>           Sockets; // Of the clients connected
+
+        std::chrono::steady_clock::time_point Started;
+
+        bool Acquire(std::chrono::steady_clock::time_point Deadline);
+        void Release();
+
+        void Convert(
+            const std::string&                    Input,
+            uint32_t                              Flags,
+            std::chrono::steady_clock::time_point Deadline,
+            PROTOCOL::RESPONSE&                   Response
+        );
+        bool Handle(int Input, int Output); // Returns false to disconnect
+        void Client(int Socket);
+
+    public:
+        COUNTERS Counters;
+
+        SERVER(int Threads, const LIMITS& Limits);
+       ~SERVER();
+
+        // Creates the socket, replacing a stale one, and returns false on
+        // failure
+        bool Listen(const char* Path);
+
+        // Accepts connections until stopped
+        void Run();
+
+        // Handles the requests on the descriptors one at a time, until the
+        // end of the input
+        void Serve(int Input, int Output);
+
+        // Stops accepting connections; may be called from a signal handler
+        void Stop();
+
+        // Request rates, throughput and latency percentiles
+        std::string GetCounters();
+};
+//------------------------------------------------------------------------------
+
+// Sends requests to a server over a Unix domain socket
+class CLIENT{
+    private:
+        int Socket;
+
+    public:
+        CLIENT();
+       ~CLIENT();
+
+        bool Connect(const char* Path);
+        void Close  ();
+
+        // Returns false if the connection failed
+        bool Convert(
+            const char*         Data,
+            size_t              Length,
+            uint32_t            Flags,
+            PROTOCOL::RESPONSE& Response
+        );
+};
+//------------------------------------------------------------------------------
+
+// Sends the input Requests times over Connections concurrent connections,
+// and reports the throughput and latency percentiles.  Returns false if any
+// connection failed.
+bool LoadTest(
+    const char*  Path,
+    const char*  Data,
+    size_t       Length,
+    uint32_t     Flags,
+    int          Connections,
+    long long    Requests,
+    std::string& Report
+);
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
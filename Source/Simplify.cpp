@@ -0,0 +1,294 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Simplify.h"
+//------------------------------------------------------------------------------
+
+// Longer runs are simplified in pieces, to bound the memory and time used
+static const size_t MaximumRun = 0x1000;
+//------------------------------------------------------------------------------
+
+SIMPLIFY::SIMPLIFY(PLOTTER* Output, double Tolerance): FILTER(Output){
+    Millimetres = Tolerance;
+    InBlock     = false;
+    LinearMode  = false;
+    Current.X   = 0;
+    Current.Y   = 0;
+    Known       = false;
+    SegmentsIn  = 0;
+    SegmentsOut = 0;
+
+    // The converter's default format, until it specifies one
+    SetUnits(true, 3);
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::SetUnits(bool Metric, int FractionDigits){
+    double Scale = pow(10.0, FractionDigits);
+    if(!Metric) Scale /= 25.4;
+
+    Tolerance = Millimetres * Scale;
+}
+//------------------------------------------------------------------------------
+
+// Squared distance from P to the segment from A to B
+double SIMPLIFY::Distance(const POINT& P, const POINT& A, const POINT& B) const{
+    double dX = (double)B.X - A.X;
+    double dY = (double)B.Y - A.Y;
+    double pX = (double)P.X - A.X;
+    double pY = (double)P.Y - A.Y;
+
+    double Dot    = pX*dX + pY*dY;
+    double Length = dX*dX + dY*dY;
+
+    if(Dot > 0 && Length > 0){
+        if(Dot >= Length){
+            pX -= dX;
+            pY -= dY;
+        }else{
+            double t = Dot / Length;
+            pX -= t*dX;
+            pY -= t*dY;
+        }
+    }
+    return pX*pX + pY*pY;
+}
+//------------------------------------------------------------------------------
+
+// Whether P lies within the tolerance of the segment from A to B.  A zero
+// tolerance is tested exactly, in integer arithmetic.  When A and B are the
+// same point, only that point is on the segment.
+bool SIMPLIFY::Within(const POINT& P, const POINT& A, const POINT& B) const{
+    if(Tolerance > 0) return Distance(P, A, B) <= Tolerance*Tolerance;
+
+    int64_t dX = (int64_t)B.X - A.X;
+    int64_t dY = (int64_t)B.Y - A.Y;
+    int64_t pX = (int64_t)P.X - A.X;
+    int64_t pY = (int64_t)P.Y - A.Y;
+
+    if(!dX && !dY) return !pX && !pY;
+
+    int64_t Dot = pX*dX + pY*dY;
+    return pX*dY == pY*dX && Dot >= 0 && Dot <= dX*dX + dY*dY;
+}
+//------------------------------------------------------------------------------
+
+// Simplifies and passes on the run so far
+void SIMPLIFY::Emit(){
+    int Count = (int)Run.size();
+    if(Count < 2){
+        Run.clear();
+        return;
+    }
+
+    Keep.assign(Count, false);
+    Keep[0] = Keep[Count-1] = true;
+
+    // Douglas-Peucker, with an explicit stack of (first, last) index pairs.
+    // A closed run has no chord to measure against, so it is first split at
+    // the vertex farthest from its start.
+    Stack.clear();
+    const POINT& Start = Run[0];
+    const POINT& End   = Run[Count-1];
+    int Opposite = 0;
+    if(Count > 2 && Start.X == End.X && Start.Y == End.Y){
+        double Farthest = 0;
+        for(int n = 1; n < Count-1; n++){
+            double dX = (double)Run[n].X - Start.X;
+            double dY = (double)Run[n].Y - Start.Y;
+            double d  = dX*dX + dY*dY;
+            if(d > Farthest){
+                Farthest = d;
+                Opposite = n;
+            }
+        }
+    }
+    if(Opposite){
+        Keep[Opposite] = true;
+        Stack.push_back(0);        Stack.push_back(Opposite);
+        Stack.push_back(Opposite); Stack.push_back(Count-1);
+    }else{
+        Stack.push_back(0);
+        Stack.push_back(Count-1);
+    }
+
+    while(!Stack.empty()){
+        int Last  = Stack.back(); Stack.pop_back();
+        int First = Stack.back(); Stack.pop_back();
+
+        // Split at the farthest vertex that is out of tolerance
+        int    Split    = -1;
+        double Farthest = -1;
+        for(int n = First+1; n < Last; n++){
+            if(Within(Run[n], Run[First], Run[Last])) continue;
+
+            double d = Distance(Run[n], Run[First], Run[Last]);
+            if(d > Farthest){
+                Farthest = d;
+                Split    = n;
+            }
+        }
+        if(Split < 0) continue;
+
+        Keep[Split] = true;
+        Stack.push_back(First); Stack.push_back(Split);
+        Stack.push_back(Split); Stack.push_back(Last );
+    }
+
+    for(int n = 1; n < Count; n++){
+        if(!Keep[n]) continue;
+        Output->Draw(Run[n].X, Run[n].Y);
+        SegmentsOut++;
+    }
+    Run.clear();
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::Format(bool Metric, int IntDigits, int FractionDigits){
+    Emit();
+    SetUnits(Metric, FractionDigits);
+    Output->Format(Metric, IntDigits, FractionDigits);
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::Aperture(int Code, const char* Diameter, int Length){
+    Emit();
+    Output->Aperture(Code, Diameter, Length);
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::Begin(){
+    Emit();
+    LinearMode = true;
+    Output->Begin();
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::End(){
+    Emit();
+    Output->End();
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::Select(int Code){
+    Emit();
+    Output->Select(Code);
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::Linear(){
+    // Many files repeat G01 on every line, which must not split the runs
+    if(LinearMode) return;
+
+    Emit();
+    LinearMode = true;
+    Output->Linear();
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::Circular(bool CCW){
+    Emit();
+    LinearMode = false;
+    Output->Circular(CCW);
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::Flash(int X, int Y){
+    Emit();
+    Current.X = X;
+    Current.Y = Y;
+    Known     = true;
+    Output->Flash(X, Y);
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::Move(int X, int Y){
+    Emit();
+    Current.X = X;
+    Current.Y = Y;
+    Known     = true;
+    Output->Move(X, Y);
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::Draw(int X, int Y){
+    SegmentsIn++;
+
+    if(InBlock || !LinearMode || !Known){
+        Current.X = X;
+        Current.Y = Y;
+        Known     = !InBlock;
+        SegmentsOut++;
+        Output->Draw(X, Y);
+        return;
+    }
+
+    if(Run.empty()) Run.push_back(Current);
+
+    Current.X = X;
+    Current.Y = Y;
+    Run.push_back(Current);
+
+    // Continue long runs from their last point
+    if(Run.size() >= MaximumRun){
+        Emit();
+        Run.push_back(Current);
+    }
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::Arc(int X, int Y, int I, int J){
+    Emit();
+    Current.X = X;
+    Current.Y = Y;
+    Known     = !InBlock;
+    Output->Arc(X, Y, I, J);
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::Circle(int X, int Y, int R){
+    Emit();
+    Current.X = X;
+    Current.Y = Y;
+    Known     = true;
+    Output->Circle(X, Y, R);
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::StepRepeat(int CountX, int CountY, int StepX, int StepY){
+    Emit();
+    InBlock = true;
+    Known   = false;
+    Output->StepRepeat(CountX, CountY, StepX, StepY);
+}
+//------------------------------------------------------------------------------
+
+void SIMPLIFY::EndStepRepeat(){
+    InBlock = false;
+    Known   = false;
+    Output->EndStepRepeat();
+}
+//------------------------------------------------------------------------------
+
+bool SIMPLIFY::Flush(){
+    Emit();
+    return Output->Flush();
+}
+//------------------------------------------------------------------------------
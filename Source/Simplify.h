@@ -0,0 +1,91 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Simplify_h
+#define Simplify_h
+//------------------------------------------------------------------------------
+
+#include <math.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "Filter.h"
+//------------------------------------------------------------------------------
+
+// Merges runs of linear draws (routed outlines and slots) into fewer draws.
+// A run is simplified with the Douglas-Peucker algorithm: every vertex that
+// is dropped lies within the tolerance of the draw that replaces it.  With a
+// tolerance of zero, only vertices exactly on a straight segment are
+// dropped.  Runs inside step-and-repeat blocks, or while circular
+// interpolation is active, are passed on unchanged.  Redundant changes to
+// linear interpolation are dropped.
+class SIMPLIFY: public FILTER{
+    private:
+        struct POINT{
+            int X, Y;
+        };
+
+        double Millimetres; // Tolerance
+        double Tolerance;   // In file units
+
+        bool InBlock;
+        bool LinearMode;
+
+        // The run so far, starting at the point before the first draw
+        std::vector<POINT> Run;
+        std::vector<bool>  Keep;
+        std::vector<int>   Stack;
+
+        POINT Current;
+        bool  Known; // The current point is unknown after a block
+
+        void   SetUnits(bool Metric, int FractionDigits);
+        double Distance(const POINT& P, const POINT& A, const POINT& B) const;
+        bool   Within  (const POINT& P, const POINT& A, const POINT& B) const;
+        void   Emit    ();
+
+    public:
+        long long SegmentsIn;  // Draws received ...
+        long long SegmentsOut; // ... and passed on
+
+        // The tolerance is in mm
+        SIMPLIFY(PLOTTER* Output, double Tolerance = 0);
+
+        void Format       (bool Metric, int IntDigits, int FractionDigits);
+        void Aperture     (int Code, const char* Diameter, int Length);
+        void Begin        ();
+        void End          ();
+        void Select       (int Code);
+        void Linear       ();
+        void Circular     (bool CCW);
+        void Flash        (int X, int Y);
+        void Move         (int X, int Y);
+        void Draw         (int X, int Y);
+        void Arc          (int X, int Y, int I, int J);
+        void Circle       (int X, int Y, int R);
+        void StepRepeat   (int CountX, int CountY, int StepX, int StepY);
+        void EndStepRepeat();
+        bool Flush        ();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
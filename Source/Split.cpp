@@ -0,0 +1,310 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Split.h"
+//------------------------------------------------------------------------------
+
+// Output buffers are smaller than for a single file, as there can be many
+static const size_t BufferSize = 0x10000;
+//------------------------------------------------------------------------------
+
+SPLIT::OUTPUT::OUTPUT(SPLIT* Owner, int Code, const std::string& Name):
+Gerber(BufferSize){
+    this->Owner = Owner;
+    this->Code  = Code;
+    this->Name  = Name;
+    Defined     = false;
+
+    File     = 0;
+    Created  = false;
+    LastUsed = 0;
+
+    Started = false;
+    Ended   = false;
+    Mode    = Mode_Linear;
+    InBlock = false;
+
+    Gerber.Open(this);
+}
+//------------------------------------------------------------------------------
+
+bool SPLIT::OUTPUT::Write(const char* Data, size_t Length){
+    return Owner->Write(this, Data, Length);
+}
+//------------------------------------------------------------------------------
+
+bool SPLIT::OUTPUT::Flush(){
+    if(!File) return true;
+    return !fflush(File);
+}
+//------------------------------------------------------------------------------
+
+SPLIT::SPLIT(const std::string& Prefix, const std::string& Suffix, int MaxOpen){
+    this->Prefix  = Prefix;
+    this->Suffix  = Suffix;
+    this->MaxOpen = MaxOpen > 0 ? MaxOpen : 1;
+
+    Open    = 0;
+    Clock   = 0;
+    Failed  = false;
+    Current = 0;
+    Length  = 0;
+
+    Formatted      = false;
+    Metric         = false;
+    IntDigits      = 0;
+    FractionDigits = 0;
+
+    Mode    = Mode_Linear;
+    InBlock = false;
+    CountX  = CountY = 0;
+    StepX   = StepY  = 0;
+}
+//------------------------------------------------------------------------------
+
+SPLIT::~SPLIT(){
+    for(auto& Output: Outputs){
+        if(Output.second->File) fclose(Output.second->File);
+        delete Output.second;
+    }
+}
+//------------------------------------------------------------------------------
+
+// The tool number is the aperture code less 10, as numbered by the converter
+SPLIT::OUTPUT* SPLIT::Get(int Code){
+    OUTPUT*& Output = Outputs[Code];
+    if(!Output){
+        Output = new OUTPUT(this, Code, Prefix + std::to_string(Code - 10) + Suffix);
+    }
+    return Output;
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::Start(OUTPUT* Output){
+    GERBER_WRITER& Gerber = Output->Gerber;
+
+    if(Formatted) Gerber.Format(Metric, IntDigits, FractionDigits);
+    if(Output->Defined){
+        Gerber.Aperture(Output->Code, Output->Diameter.data(), Output->Diameter.length());
+    }
+    Gerber.Begin();
+    Gerber.Select(Output->Code);
+
+    Output->Started = true;
+    Output->Mode    = Mode_Linear;
+}
+//------------------------------------------------------------------------------
+
+// Brings the current output up to date with the modal state, and returns
+// null if no aperture is selected
+SPLIT::OUTPUT* SPLIT::Prepare(){
+    OUTPUT* Output = Current;
+    if(!Output) return 0;
+
+    if(!Output->Started) Start(Output);
+
+    if(Output->Mode != Mode){
+        if(Mode == Mode_Linear) Output->Gerber.Linear();
+        else                    Output->Gerber.Circular(Mode == Mode_CCW);
+        Output->Mode = Mode;
+    }
+    if(InBlock && !Output->InBlock){
+        Output->Gerber.StepRepeat(CountX, CountY, StepX, StepY);
+        Output->InBlock = true;
+        Blocked.push_back(Output);
+    }
+    return Output;
+}
+//------------------------------------------------------------------------------
+
+// Closes the least recently written file
+void SPLIT::Evict(){
+    OUTPUT* Oldest = 0;
+
+    for(auto& Entry: Outputs){
+        OUTPUT* Output = Entry.second;
+        if(Output->File && (!Oldest || Output->LastUsed < Oldest->LastUsed)){
+            Oldest = Output;
+        }
+    }
+    if(!Oldest) return;
+
+    if(fclose(Oldest->File)) Failed = true;
+    Oldest->File = 0;
+    Open--;
+}
+//------------------------------------------------------------------------------
+
+bool SPLIT::Write(OUTPUT* Output, const char* Data, size_t Length){
+    if(!Output->File){
+        if(Open >= MaxOpen) Evict();
+
+        Output->File = fopen(Output->Name.c_str(), Output->Created ? "a" : "w");
+        if(!Output->File){
+            Failed = true;
+            return false;
+        }
+        Output->Created = true;
+        Open++;
+    }
+    Output->LastUsed = ++Clock;
+    this->Length    += Length;
+
+    if(fwrite(Data, 1, Length, Output->File) != Length){
+        Failed = true;
+        return false;
+    }
+    return true;
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::Format(bool Metric, int IntDigits, int FractionDigits){
+    Formatted            = true;
+    this->Metric         = Metric;
+    this->IntDigits      = IntDigits;
+    this->FractionDigits = FractionDigits;
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::Aperture(int Code, const char* Diameter, int Length){
+    OUTPUT* Output = Get(Code);
+    Output->Diameter.assign(Diameter, Length);
+    Output->Defined = true;
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::Begin(){
+    Mode = Mode_Linear;
+}
+//------------------------------------------------------------------------------
+
+// Every aperture gets a file, even if it was not used
+void SPLIT::End(){
+    if(InBlock) EndStepRepeat();
+
+    for(auto& Entry: Outputs){
+        OUTPUT* Output = Entry.second;
+        if(Output->Ended) continue;
+
+        if(!Output->Started) Start(Output);
+        Output->Gerber.End();
+        Output->Ended = true;
+    }
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::Select(int Code){
+    Current = Get(Code);
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::Linear(){
+    Mode = Mode_Linear;
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::Circular(bool CCW){
+    Mode = CCW ? Mode_CCW : Mode_CW;
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::Flash(int X, int Y){
+    OUTPUT* Output = Prepare();
+    if(Output) Output->Gerber.Flash(X, Y);
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::Move(int X, int Y){
+    OUTPUT* Output = Prepare();
+    if(Output) Output->Gerber.Move(X, Y);
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::Draw(int X, int Y){
+    OUTPUT* Output = Prepare();
+    if(Output) Output->Gerber.Draw(X, Y);
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::Arc(int X, int Y, int I, int J){
+    OUTPUT* Output = Prepare();
+    if(Output) Output->Gerber.Arc(X, Y, I, J);
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::Circle(int X, int Y, int R){
+    OUTPUT* Output = Prepare();
+    if(Output) Output->Gerber.Circle(X, Y, R);
+}
+//------------------------------------------------------------------------------
+
+// Blocks are only opened in the outputs that draw something in them
+void SPLIT::StepRepeat(int CountX, int CountY, int StepX, int StepY){
+    InBlock      = true;
+    this->CountX = CountX;
+    this->CountY = CountY;
+    this->StepX  = StepX;
+    this->StepY  = StepY;
+}
+//------------------------------------------------------------------------------
+
+void SPLIT::EndStepRepeat(){
+    for(size_t n = 0; n < Blocked.size(); n++){
+        Blocked[n]->Gerber.EndStepRepeat();
+        Blocked[n]->InBlock = false;
+    }
+    Blocked.clear();
+    InBlock = false;
+}
+//------------------------------------------------------------------------------
+
+bool SPLIT::Flush(){
+    bool Result = !Failed;
+
+    for(auto& Entry: Outputs){
+        OUTPUT* Output = Entry.second;
+        if(Output->Started && !Output->Gerber.Flush()) Result = false;
+    }
+    return Result;
+}
+//------------------------------------------------------------------------------
+
+bool SPLIT::Close(){
+    End();
+    bool Result = Flush();
+
+    for(auto& Entry: Outputs){
+        OUTPUT* Output = Entry.second;
+        if(Output->File){
+            if(fclose(Output->File)) Result = false;
+            Output->File = 0;
+            Open--;
+        }
+    }
+    return Result && !Failed;
+}
+//------------------------------------------------------------------------------
+
+std::vector<std::string> SPLIT::Files() const{
+    std::vector<std::string> Result;
+    for(auto& Entry: Outputs) Result.push_back(Entry.second->Name);
+    return Result;
+}
+//------------------------------------------------------------------------------
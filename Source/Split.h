@@ -0,0 +1,131 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Split_h
+#define Split_h
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Gerber.h"
+//------------------------------------------------------------------------------
+
+// Writes every aperture to its own Gerber file, "<Prefix><Tool><Suffix>",
+// during a single conversion.  Every file has its own buffered writer, and
+// receives the format, its aperture and the operations drawn with it, with
+// the interpolation mode and step-and-repeat blocks that apply to them.
+//
+// Files are only open while their buffers are written out, and at most
+// MaxOpen at a time: the least recently written one is closed to make room,
+// and reopened for appending when it is written to again.
+class SPLIT: public PLOTTER{
+    private:
+        enum MODE{
+            Mode_Linear,
+            Mode_CW,
+            Mode_CCW
+        };
+
+        struct OUTPUT: public SINK{
+            SPLIT* Owner;
+
+            int         Code;
+            std::string Name;
+            std::string Diameter;
+            bool        Defined; // The aperture was defined in the input
+
+            FILE*     File;     // Null while closed
+            bool      Created;
+            long long LastUsed;
+
+            GERBER_WRITER Gerber;
+            bool          Started;
+            bool          Ended;
+            MODE          Mode;
+            bool          InBlock;
+
+            OUTPUT(SPLIT* Owner, int Code, const std::string& Name);
+
+            bool Write(const char* Data, size_t Length);
+            bool Flush();
+        };
+
+        std::string Prefix;
+        std::string Suffix;
+        int         MaxOpen;
+        int         Open;
+        long long   Clock;
+        bool        Failed;
+
+        std::map<int, OUTPUT*> Outputs;
+        std::vector<OUTPUT*>   Blocked; // Outputs in the current block
+        OUTPUT*                Current;
+
+        bool Formatted;
+        bool Metric;
+        int  IntDigits;
+        int  FractionDigits;
+
+        MODE Mode;
+        bool InBlock;
+        int  CountX, CountY, StepX, StepY;
+
+        OUTPUT* Get    (int Code);
+        OUTPUT* Prepare();
+        void    Start  (OUTPUT* Output);
+        void    Evict  ();
+        bool    Write  (OUTPUT* Output, const char* Data, size_t Length);
+
+    public:
+        long long Length; // Bytes written to all the files
+
+        SPLIT(const std::string& Prefix, const std::string& Suffix, int MaxOpen = 32);
+       ~SPLIT();
+
+        void Format       (bool Metric, int IntDigits, int FractionDigits);
+        void Aperture     (int Code, const char* Diameter, int Length);
+        void Begin        ();
+        void End          ();
+        void Select       (int Code);
+        void Linear       ();
+        void Circular     (bool CCW);
+        void Flash        (int X, int Y);
+        void Move         (int X, int Y);
+        void Draw         (int X, int Y);
+        void Arc          (int X, int Y, int I, int J);
+        void Circle       (int X, int Y, int R);
+        void StepRepeat   (int CountX, int CountY, int StepX, int StepY);
+        void EndStepRepeat();
+        bool Flush        ();
+
+        // Ends and closes all the files.  Returns false if any output failed.
+        bool Close();
+
+        // The names of the files, in order of aperture code
+        std::vector<std::string> Files() const;
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
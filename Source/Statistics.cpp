@@ -0,0 +1,135 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Statistics.h"
+
+#include <chrono>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+//------------------------------------------------------------------------------
+
+PHASE_TIME::PHASE_TIME(){
+    Wall = 0;
+    CPU  = 0;
+}
+//------------------------------------------------------------------------------
+
+void PHASE_TIME::Add(const PHASE_TIME& Time){
+    Wall += Time.Wall;
+    CPU  += Time.CPU;
+}
+//------------------------------------------------------------------------------
+
+void PHASE_TIME::Subtract(const PHASE_TIME& Time){
+    Wall -= Time.Wall;
+    CPU  -= Time.CPU;
+}
+//------------------------------------------------------------------------------
+
+STOPWATCH::STOPWATCH(){
+    Wall = GetWall();
+    CPU  = GetCPU ();
+}
+//------------------------------------------------------------------------------
+
+double STOPWATCH::GetWall(){
+    std::chrono::duration<double> Time =
+        std::chrono::steady_clock::now().time_since_epoch();
+    return Time.count();
+}
+//------------------------------------------------------------------------------
+
+double STOPWATCH::GetCPU(){
+    #ifdef _WIN32
+        FILETIME Creation, Exit, Kernel, User;
+        if(!GetThreadTimes(GetCurrentThread(), &Creation, &Exit, &Kernel, &User)){
+            return 0;
+        }
+        ULARGE_INTEGER k, u;
+        k.LowPart  = Kernel.dwLowDateTime;
+        k.HighPart = Kernel.dwHighDateTime;
+        u.LowPart  = User  .dwLowDateTime;
+        u.HighPart = User  .dwHighDateTime;
+        return (k.QuadPart + u.QuadPart) * 1e-7;
+    #else
+        struct timespec Time;
+        if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Time)) return 0;
+        return Time.tv_sec + Time.tv_nsec * 1e-9;
+    #endif
+}
+//------------------------------------------------------------------------------
+
+void STOPWATCH::Split(PHASE_TIME& Phase){
+    double Wall = GetWall();
+    double CPU  = GetCPU ();
+
+    Phase.Wall += Wall - this->Wall;
+    Phase.CPU  += CPU  - this->CPU;
+
+    this->Wall = Wall;
+    this->CPU  = CPU;
+}
+//------------------------------------------------------------------------------
+
+PHASE_TIME& OutputTime(){
+    static thread_local PHASE_TIME Time;
+    return Time;
+}
+//------------------------------------------------------------------------------
+
+TOOL_COUNTS::TOOL_COUNTS(){
+    Hits    = 0;
+    Slots   = 0;
+    Routes  = 0;
+    Arcs    = 0;
+    Repeats = 0;
+}
+//------------------------------------------------------------------------------
+
+void TOOL_COUNTS::Add(const TOOL_COUNTS& Counts){
+    Hits    += Counts.Hits;
+    Slots   += Counts.Slots;
+    Routes  += Counts.Routes;
+    Arcs    += Counts.Arcs;
+    Repeats += Counts.Repeats;
+}
+//------------------------------------------------------------------------------
+
+void STATISTICS::Clear(){
+    Read  = PHASE_TIME();
+    Parse = PHASE_TIME();
+    Emit  = PHASE_TIME();
+
+    Tools      .clear();
+    Unsupported.clear();
+    Ignored    .clear();
+}
+//------------------------------------------------------------------------------
+
+void STATISTICS::Add(const STATISTICS& Statistics){
+    for(auto& Tool: Statistics.Tools      ) Tools      [Tool.first].Add(Tool.second);
+    for(auto& Code: Statistics.Unsupported) Unsupported[Code.first] += Code.second;
+    for(auto& Code: Statistics.Ignored    ) Ignored    [Code.first] += Code.second;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,106 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Statistics_h
+#define Statistics_h
+//------------------------------------------------------------------------------
+
+#include <map>
+#include <string>
+//------------------------------------------------------------------------------
+
+// Time spent in a phase of the conversion, in seconds
+struct PHASE_TIME{
+    double Wall;
+    double CPU;
+
+    PHASE_TIME();
+
+    void Add     (const PHASE_TIME& Time);
+    void Subtract(const PHASE_TIME& Time);
+};
+//------------------------------------------------------------------------------
+
+// Measures the wall time, and the CPU time of the calling thread
+class STOPWATCH{
+    private:
+        double Wall;
+        double CPU;
+
+        static double GetWall();
+        static double GetCPU ();
+
+    public:
+        STOPWATCH();
+
+        // Adds the time since construction, or the previous split, to the
+        // phase and restarts
+        void Split(PHASE_TIME& Phase);
+};
+//------------------------------------------------------------------------------
+
+// The time that the writers on the calling thread spent passing their output
+// to the sinks, so far.  The writers drain while the converter parses, so the
+// converter books the difference over the parse as emitting instead.
+PHASE_TIME& OutputTime();
+//------------------------------------------------------------------------------
+
+struct TOOL_COUNTS{
+    long long Hits;    // Drilled holes, including repeated ones
+    long long Slots;   // G85 slots, which are also counted as routes
+    long long Routes;  // Linear route segments
+    long long Arcs;    // Circular route segments and canned circles
+    long long Repeats; // R commands
+
+    TOOL_COUNTS();
+
+    void Add(const TOOL_COUNTS& Counts);
+};
+//------------------------------------------------------------------------------
+
+// Counters and phase times of a conversion.  Depending on the conversion
+// mode, some phases overlap others:
+//
+// - Serial: reading is filling the input blocks, or faulting in the mapped
+//   file, and emitting is passing the output to the sinks.  The rest,
+//   including formatting the output, is parsing.
+// - Pipelined: every phase is a thread, so the wall times overlap.
+// - Parallel: reading is the header and the pre-scan, and the CPU time of
+//   the parse is summed over all the parts.
+struct STATISTICS{
+    PHASE_TIME Read;
+    PHASE_TIME Parse;
+    PHASE_TIME Emit;
+
+    std::map<int, TOOL_COUNTS> Tools; // By tool number
+
+    // By code, for example "G93"
+    std::map<std::string, long long> Unsupported;
+    std::map<std::string, long long> Ignored;
+
+    void Clear();
+
+    // Adds the counters, but not the times, of the other statistics
+    void Add(const STATISTICS& Statistics);
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
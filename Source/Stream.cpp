@@ -0,0 +1,104 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Stream.h"
+//------------------------------------------------------------------------------
+
+MEMORY_SOURCE::MEMORY_SOURCE(const char* Data, size_t Length){
+    this->Data   = Data;
+    this->Length = Length;
+    Position     = 0;
+}
+//------------------------------------------------------------------------------
+
+size_t MEMORY_SOURCE::Read(char* Buffer, size_t Size){
+    if(Size > Length - Position) Size = Length - Position;
+    memcpy(Buffer, Data + Position, Size);
+    Position += Size;
+    return Size;
+}
+//------------------------------------------------------------------------------
+
+CALLBACK_SOURCE::CALLBACK_SOURCE(FUNCTION Callback){
+    this->Callback = Callback;
+}
+//------------------------------------------------------------------------------
+
+size_t CALLBACK_SOURCE::Read(char* Buffer, size_t Size){
+    return Callback(Buffer, Size);
+}
+//------------------------------------------------------------------------------
+
+FILE_SOURCE::FILE_SOURCE(FILE* File){
+    this->File = File;
+    Length     = 0;
+}
+//------------------------------------------------------------------------------
+
+size_t FILE_SOURCE::Read(char* Buffer, size_t Size){
+    size_t Count = fread(Buffer, 1, Size, File);
+    Length += Count;
+    return Count;
+}
+//------------------------------------------------------------------------------
+
+NULL_SINK::NULL_SINK(){
+    Length = 0;
+}
+//------------------------------------------------------------------------------
+
+bool NULL_SINK::Write(const char* Data, size_t Length){
+    this->Length += Length;
+    return true;
+}
+//------------------------------------------------------------------------------
+
+bool STRING_SINK::Write(const char* Data, size_t Length){
+    this->Data.append(Data, Length);
+    return true;
+}
+//------------------------------------------------------------------------------
+
+CALLBACK_SINK::CALLBACK_SINK(FUNCTION Callback){
+    this->Callback = Callback;
+}
+//------------------------------------------------------------------------------
+
+bool CALLBACK_SINK::Write(const char* Data, size_t Length){
+    return Callback(Data, Length);
+}
+//------------------------------------------------------------------------------
+
+FILE_SINK::FILE_SINK(FILE* File){
+    this->File = File;
+    Length     = 0;
+}
+//------------------------------------------------------------------------------
+
+bool FILE_SINK::Write(const char* Data, size_t Length){
+    this->Length += Length;
+    return fwrite(Data, 1, Length, File) == Length;
+}
+//------------------------------------------------------------------------------
+
+bool FILE_SINK::Flush(){
+    return !fflush(File);
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,144 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Stream_h
+#define Stream_h
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+
+#include <functional>
+#include <string>
+//------------------------------------------------------------------------------
+
+// Pull interface for input data
+class SOURCE{
+    public:
+        virtual ~SOURCE(){}
+
+        // Returns the number of bytes read, or 0 at the end of the input
+        virtual size_t Read(char* Buffer, size_t Size) = 0;
+};
+//------------------------------------------------------------------------------
+
+// Push interface for output data
+class SINK{
+    public:
+        virtual ~SINK(){}
+
+        // Returns false on failure
+        virtual bool Write(const char* Data, size_t Length) = 0;
+        virtual bool Flush(){ return true; }
+};
+//------------------------------------------------------------------------------
+
+class MEMORY_SOURCE: public SOURCE{
+    private:
+        const char* Data;
+        size_t      Length;
+        size_t      Position;
+
+    public:
+        MEMORY_SOURCE(const char* Data, size_t Length);
+
+        size_t Read(char* Buffer, size_t Size);
+};
+//------------------------------------------------------------------------------
+
+class CALLBACK_SOURCE: public SOURCE{
+    public:
+        typedef std::function<size_t(char* Buffer, size_t Size)> FUNCTION;
+
+    private:
+        FUNCTION Callback;
+
+    public:
+        CALLBACK_SOURCE(FUNCTION Callback);
+
+        size_t Read(char* Buffer, size_t Size);
+};
+//------------------------------------------------------------------------------
+
+// Does not take ownership of the file
+class FILE_SOURCE: public SOURCE{
+    private:
+        FILE* File;
+
+    public:
+        long long Length; // Bytes read so far
+
+        FILE_SOURCE(FILE* File);
+
+        size_t Read(char* Buffer, size_t Size);
+};
+//------------------------------------------------------------------------------
+
+// Discards the data, but counts the bytes
+class NULL_SINK: public SINK{
+    public:
+        size_t Length;
+
+        NULL_SINK();
+
+        bool Write(const char* Data, size_t Length);
+};
+//------------------------------------------------------------------------------
+
+class STRING_SINK: public SINK{
+    public:
+        std::string Data;
+
+        bool Write(const char* Data, size_t Length);
+};
+//------------------------------------------------------------------------------
+
+class CALLBACK_SINK: public SINK{
+    public:
+        typedef std::function<bool(const char* Data, size_t Length)> FUNCTION;
+
+    private:
+        FUNCTION Callback;
+
+    public:
+        CALLBACK_SINK(FUNCTION Callback);
+
+        bool Write(const char* Data, size_t Length);
+};
+//------------------------------------------------------------------------------
+
+// Does not take ownership of the file, and never seeks, so that it can
+// write to a pipe
+class FILE_SINK: public SINK{
+    private:
+        FILE* File;
+
+    public:
+        long long Length; // Bytes written so far
+
+        FILE_SINK(FILE* File);
+
+        bool Write(const char* Data, size_t Length);
+        bool Flush();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,245 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Svg.h"
+//------------------------------------------------------------------------------
+
+SVG_WRITER::SVG_WRITER(size_t BufferSize): Writer(BufferSize), Body(BufferSize){
+    Open(0);
+}
+//------------------------------------------------------------------------------
+
+void SVG_WRITER::Open(SINK* Sink){
+    Writer.Open(Sink);
+    Body  .Open(&BodySink);
+    BodySink.Data.clear();
+
+    Metric         = true;
+    FractionDigits = 3;
+    Scale          = 1e3;
+    Width          = 0;
+    Radius         = "0";
+    CCW            = false;
+    X = Y          = 0;
+    InGroup        = false;
+    InPath         = false;
+    Empty          = true;
+    Left = Bottom  = Right = Top = 0;
+
+    Apertures.clear();
+}
+//------------------------------------------------------------------------------
+
+bool SVG_WRITER::Close(){
+    EndPath();
+    if(InGroup){
+        Body.String("</g>\n");
+        InGroup = false;
+    }
+    bool Result = Body.Flush();
+
+    // Whole file units that cover the drawing, with y pointing up
+    int ViewLeft   = (int)floor(Left  );
+    int ViewBottom = (int)floor(Bottom);
+    int ViewWidth  = (int)ceil (Right) - ViewLeft;
+    int ViewHeight = (int)ceil (Top  ) - ViewBottom;
+    const char* Units = Metric ? "mm" : "in";
+
+    Writer.String("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                  "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"");
+    Writer.Decimal(ViewWidth, FractionDigits);
+    Writer.String(Units);
+    Writer.String("\" height=\"");
+    Writer.Decimal(ViewHeight, FractionDigits);
+    Writer.String(Units);
+    Writer.String("\" viewBox=\"");
+    Writer.Int(ViewLeft);                 Writer.Char(' ');
+    Writer.Int(-ViewBottom - ViewHeight); Writer.Char(' ');
+    Writer.Int(ViewWidth);                Writer.Char(' ');
+    Writer.Int(ViewHeight);
+    Writer.String("\">\n"
+                  "<g transform=\"scale(1 -1)\" stroke-linecap=\"round\" "
+                  "stroke-linejoin=\"round\">\n");
+
+    Writer.String(BodySink.Data.data(), BodySink.Data.length());
+    BodySink.Data.clear();
+    BodySink.Data.shrink_to_fit();
+
+    Writer.String("</g>\n</svg>\n");
+    return Writer.Flush() && Result;
+}
+//------------------------------------------------------------------------------
+
+// The drawing is only written by Close
+bool SVG_WRITER::Flush(){
+    return Writer.Flush();
+}
+//------------------------------------------------------------------------------
+
+void SVG_WRITER::Format(bool Metric, int IntDigits, int FractionDigits){
+    this->Metric         = Metric;
+    this->FractionDigits = FractionDigits;
+    Scale = pow(10.0, FractionDigits);
+}
+//------------------------------------------------------------------------------
+
+void SVG_WRITER::Aperture(int Code, const char* Diameter, int Length){
+    std::string Value(Diameter, Length);
+    Apertures[Code] = atof(Value.c_str());
+}
+//------------------------------------------------------------------------------
+
+void SVG_WRITER::Begin(){}
+void SVG_WRITER::End  (){}
+//------------------------------------------------------------------------------
+
+void SVG_WRITER::StartPath(){
+    if(InPath) return;
+    Body.String("<path fill=\"none\" stroke=\"#000\" d=\"");
+    InPath = true;
+}
+//------------------------------------------------------------------------------
+
+void SVG_WRITER::EndPath(){
+    if(!InPath) return;
+    Body.String("\"/>\n");
+    InPath = false;
+}
+//------------------------------------------------------------------------------
+
+// Every selection opens a group with the stroke width of the tool
+void SVG_WRITER::Select(int Code){
+    EndPath();
+    if(InGroup) Body.String("</g>\n");
+
+    auto Found = Apertures.find(Code);
+    Width = Found == Apertures.end() ? 0 : Found->second * Scale;
+
+    char Buffer[32];
+    snprintf(Buffer, sizeof(Buffer), "%.10g", Width / 2);
+    Radius = Buffer;
+
+    Body.String("<g class=\"T");
+    Body.Int2  (Code - 10);
+    Body.String("\" stroke-width=\"");
+    Body.Real  (Width);
+    Body.String("\">\n");
+    InGroup = true;
+}
+//------------------------------------------------------------------------------
+
+void SVG_WRITER::Linear(){}
+//------------------------------------------------------------------------------
+
+void SVG_WRITER::Circular(bool CCW){
+    this->CCW = CCW;
+}
+//------------------------------------------------------------------------------
+
+void SVG_WRITER::Flash(int X, int Y){
+    EndPath();
+
+    Body.String("<circle cx=\""); Body.Int(X);
+    Body.String("\" cy=\""     ); Body.Int(Y);
+    Body.String("\" r=\""      ); Body.String(Radius.data(), Radius.length());
+    Body.String("\"/>\n");
+
+    Extend(X, Y, Width / 2);
+    this->X = X;
+    this->Y = Y;
+}
+//------------------------------------------------------------------------------
+
+// Paths only start when something is drawn
+void SVG_WRITER::Move(int X, int Y){
+    if(InPath) Point('M', X, Y);
+
+    this->X = X;
+    this->Y = Y;
+}
+//------------------------------------------------------------------------------
+
+void SVG_WRITER::Draw(int X, int Y){
+    if(!InPath){
+        StartPath();
+        Point('M', this->X, this->Y);
+    }
+    Point('L', X, Y);
+
+    Extend(this->X, this->Y, Width / 2);
+    Extend(      X,       Y, Width / 2);
+    this->X = X;
+    this->Y = Y;
+}
+//------------------------------------------------------------------------------
+
+// The y axis points up in the group, so the positive angle direction of the
+// sweep flag is counter-clockwise.  A full circle is drawn in two halves,
+// because an arc to its own start point is not drawn at all.
+void SVG_WRITER::Arc(int X, int Y, int I, int J){
+    if(!InPath){
+        StartPath();
+        Point('M', this->X, this->Y);
+    }
+
+    double CentreX = (double)this->X + I;
+    double CentreY = (double)this->Y + J;
+    double R       = hypot((double)I, (double)J);
+
+    double From = atan2(this->Y - CentreY, this->X - CentreX);
+    double To   = atan2(      Y - CentreY,       X - CentreX);
+
+    double Sweep = CCW ? To - From : From - To;
+    if(Sweep < 0) Sweep += 2*M_PI;
+
+    if(X == this->X && Y == this->Y){
+        Body.Char ('A'); Body.Real(R); Body.Char(' '); Body.Real(R);
+        Body.String(CCW ? " 0 0 1 " : " 0 0 0 ");
+        Body.Int  (this->X + 2*I); Body.Char(' '); Body.Int(this->Y + 2*J);
+    }
+    Body.Char  ('A'); Body.Real(R); Body.Char(' '); Body.Real(R);
+    Body.String(" 0 ");
+    Body.Char  (Sweep > M_PI ? '1' : '0');
+    Body.String(CCW ? " 1 " : " 0 ");
+    Body.Int   (X); Body.Char(' '); Body.Int(Y);
+
+    Extend(CentreX, CentreY, R + Width / 2);
+    this->X = X;
+    this->Y = Y;
+}
+//------------------------------------------------------------------------------
+
+void SVG_WRITER::Circle(int X, int Y, int R){
+    EndPath();
+
+    Body.String("<circle cx=\""); Body.Int(X);
+    Body.String("\" cy=\""     ); Body.Int(Y);
+    Body.String("\" r=\""      ); Body.Int(R);
+    Body.String("\" fill=\"none\" stroke=\"#000\"/>\n");
+
+    Extend(X, Y, R + Width / 2);
+    this->X = X;
+    this->Y = Y;
+}
+//------------------------------------------------------------------------------
+
+void SVG_WRITER::StepRepeat(int CountX, int CountY, int StepX, int StepY){}
+void SVG_WRITER::EndStepRepeat(){}
+//------------------------------------------------------------------------------
@@ -0,0 +1,112 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Svg_h
+#define Svg_h
+//------------------------------------------------------------------------------
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <map>
+#include <string>
+
+#include "Plotter.h"
+#include "Writer.h"
+//------------------------------------------------------------------------------
+
+// Formats the output as an SVG drawing, in the file units so that all the
+// coordinates stay integers.  Holes are filled circles, and routes are
+// stroked paths with round ends, grouped by tool.
+//
+// The view box is only known at the end, so the body is kept in memory until
+// Close writes the whole drawing.  Step-and-repeat blocks are not supported,
+// and must be unrolled first (see UNROLL).
+class SVG_WRITER: public PLOTTER{
+    private:
+        WRITER      Writer;
+        WRITER      Body;
+        STRING_SINK BodySink;
+
+        bool   Metric;
+        int    FractionDigits;
+        double Scale; // File units per mm or inch
+
+        std::map<int, double> Apertures; // Diameters in mm or inches
+
+        double      Width;  // Of the selected tool, in file units
+        std::string Radius; // Half the width, formatted once per tool
+        bool   CCW;
+        int    X, Y;  // Current point
+
+        bool InGroup;
+        bool InPath;
+
+        // Of the drawing, in file units
+        bool   Empty;
+        double Left, Bottom, Right, Top;
+
+        inline void Extend(double X, double Y, double R){
+            if(Empty){
+                Left  = X - R; Bottom = Y - R;
+                Right = X + R; Top    = Y + R;
+                Empty = false;
+                return;
+            }
+            if(Left   > X - R) Left   = X - R;
+            if(Bottom > Y - R) Bottom = Y - R;
+            if(Right  < X + R) Right  = X + R;
+            if(Top    < Y + R) Top    = Y + R;
+        }
+
+        inline void Point(char Command, int X, int Y){
+            Body.Char(Command); Body.Int(X);
+            Body.Char(' '    ); Body.Int(Y);
+        }
+
+        void StartPath();
+        void EndPath  ();
+
+    public:
+        SVG_WRITER(size_t BufferSize = 0x40000);
+
+        void Open (SINK* Sink);
+        bool Close(); // Writes the drawing and returns false on error
+        bool Flush();
+
+        void Format       (bool Metric, int IntDigits, int FractionDigits);
+        void Aperture     (int Code, const char* Diameter, int Length);
+        void Begin        ();
+        void End          ();
+        void Select       (int Code);
+        void Linear       ();
+        void Circular     (bool CCW);
+        void Flash        (int X, int Y);
+        void Move         (int X, int Y);
+        void Draw         (int X, int Y);
+        void Arc          (int X, int Y, int I, int J);
+        void Circle       (int X, int Y, int R);
+        void StepRepeat   (int CountX, int CountY, int StepX, int StepY);
+        void EndStepRepeat();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,157 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "ThreadPool.h"
+//------------------------------------------------------------------------------
+
+// Index of the worker running on this thread, or -1 on outside threads
+static thread_local int WorkerIndex = -1;
+//------------------------------------------------------------------------------
+
+THREAD_POOL::THREAD_POOL(int Threads){
+    if(Threads <= 0) Threads = std::thread::hardware_concurrency();
+    if(Threads <= 0) Threads = 1;
+
+    Count    = Threads;
+    Queues   = new QUEUE[Count];
+    Queued   = 0;
+    Pending  = 0;
+    Next     = 0;
+    Stopping = false;
+
+    for(int n = 0; n < Count; n++){
+        this->Threads.push_back(std::thread(&THREAD_POOL::Run, this, n));
+    }
+}
+//------------------------------------------------------------------------------
+
+THREAD_POOL::~THREAD_POOL(){
+    Wait();
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Stopping = true;
+    }
+    Signal.notify_all();
+    for(size_t n = 0; n < Threads.size(); n++) Threads[n].join();
+    delete[] Queues;
+}
+//------------------------------------------------------------------------------
+
+int THREAD_POOL::Size(){
+    return Count;
+}
+//------------------------------------------------------------------------------
+
+void THREAD_POOL::Add(TASK Task){
+    int Worker = WorkerIndex;
+    if(Worker < 0) Worker = Next++ % Count;
+
+    Pending++;
+    {
+        std::lock_guard<std::mutex> Lock(Queues[Worker].Mutex);
+        Queues[Worker].Tasks.push_back(std::move(Task));
+    }
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Queued++;
+    }
+    Signal.notify_one();
+}
+//------------------------------------------------------------------------------
+
+bool THREAD_POOL::Take(int Worker, TASK& Task){
+    if(Worker >= 0){
+        QUEUE& Own = Queues[Worker];
+        std::lock_guard<std::mutex> Lock(Own.Mutex);
+        if(!Own.Tasks.empty()){
+            Task = std::move(Own.Tasks.back());
+            Own.Tasks.pop_back();
+            Queued--;
+            return true;
+        }
+    }
+    int Start = Worker >= 0 ? Worker+1 : 0;
+    for(int n = 0; n < Count; n++){
+        QUEUE& Victim = Queues[(Start+n) % Count];
+        std::lock_guard<std::mutex> Lock(Victim.Mutex);
+        if(!Victim.Tasks.empty()){
+            Task = std::move(Victim.Tasks.front());
+            Victim.Tasks.pop_front();
+            Queued--;
+            return true;
+        }
+    }
+    return false;
+}
+//------------------------------------------------------------------------------
+
+void THREAD_POOL::Execute(TASK& Task){
+    Task();
+    Task = TASK();
+
+    Pending--;
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+    }
+    Idle.notify_all();
+}
+//------------------------------------------------------------------------------
+
+void THREAD_POOL::Run(int Worker){
+    WorkerIndex = Worker;
+
+    TASK Task;
+    while(true){
+        if(Take(Worker, Task)){
+            Execute(Task);
+            continue;
+        }
+        std::unique_lock<std::mutex> Lock(Mutex);
+        Signal.wait(Lock, [this]{ return Stopping || Queued > 0; });
+        if(Stopping && Queued == 0) return;
+    }
+}
+//------------------------------------------------------------------------------
+
+void THREAD_POOL::Wait(){
+    TASK Task;
+    while(Pending > 0){
+        if(Take(WorkerIndex, Task)){
+            Execute(Task);
+            continue;
+        }
+        std::unique_lock<std::mutex> Lock(Mutex);
+        Idle.wait_for(Lock, std::chrono::milliseconds(1), [this]{ return Pending == 0; });
+    }
+}
+//------------------------------------------------------------------------------
+
+void THREAD_POOL::Wait(const std::atomic<int>& Remaining){
+    TASK Task;
+    while(Remaining > 0){
+        if(Take(WorkerIndex, Task)){
+            Execute(Task);
+            continue;
+        }
+        std::unique_lock<std::mutex> Lock(Mutex);
+        Idle.wait_for(Lock, std::chrono::milliseconds(1), [&Remaining]{ return Remaining <= 0; });
+    }
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,84 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef ThreadPool_h
+#define ThreadPool_h
+//------------------------------------------------------------------------------
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+//------------------------------------------------------------------------------
+
+// Work-stealing thread pool.  Every worker has its own task queue: the owner
+// takes the newest task from the back, while idle workers steal the oldest
+// tasks from the front of the other queues.
+class THREAD_POOL{
+    public:
+        typedef std::function<void()> TASK;
+
+    private:
+        struct QUEUE{
+            std::mutex       Mutex;
+            std::deque<TASK> Tasks;
+        };
+
+        int    Count;
+        QUEUE* Queues;
+
+        std::vector<std::thread> Threads;
+
+        std::mutex              Mutex;
+        std::condition_variable Signal; // Tasks available or stopping
+        std::condition_variable Idle;   // A task finished
+
+        std::atomic<int>      Queued;   // Tasks waiting in a queue
+        std::atomic<int>      Pending;  // Tasks queued or running
+        std::atomic<unsigned> Next;     // Round-robin queue for outside tasks
+        bool                  Stopping;
+
+        bool Take   (int Worker, TASK& Task);
+        void Execute(TASK& Task);
+        void Run    (int Worker);
+
+    public:
+        // Threads = 0 uses one thread per hardware core
+        THREAD_POOL(int Threads = 0);
+       ~THREAD_POOL();
+
+        int  Size();
+        void Add (TASK Task);
+
+        // Blocks until all tasks finished, helping with the work meanwhile.
+        // Must not be called from within a task.
+        void Wait();
+
+        // Blocks until the counter, decremented by the caller's tasks,
+        // reaches zero.  This one may be called from within a task.
+        void Wait(const std::atomic<int>& Remaining);
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,123 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Unroll.h"
+//------------------------------------------------------------------------------
+
+UNROLL::UNROLL(PLOTTER* Output): FILTER(Output){
+    InBlock   = false;
+    Unrolling = false;
+    CountX    = CountY  = 0;
+    StepX     = StepY   = 0;
+    OffsetX   = OffsetY = 0;
+}
+//------------------------------------------------------------------------------
+
+void UNROLL::End(){
+    if(InBlock) EndStepRepeat();
+    Output->End();
+}
+//------------------------------------------------------------------------------
+
+void UNROLL::Select(int Code){
+    if(InBlock && !Unrolling) Block.Select(Code);
+    else                      Output->Select(Code);
+}
+//------------------------------------------------------------------------------
+
+void UNROLL::Linear(){
+    if(InBlock && !Unrolling) Block.Linear();
+    else                      Output->Linear();
+}
+//------------------------------------------------------------------------------
+
+void UNROLL::Circular(bool CCW){
+    if(InBlock && !Unrolling) Block.Circular(CCW);
+    else                      Output->Circular(CCW);
+}
+//------------------------------------------------------------------------------
+
+void UNROLL::Flash(int X, int Y){
+    if(InBlock && !Unrolling) Block .Flash(X, Y);
+    else                      Output->Flash(X + OffsetX, Y + OffsetY);
+}
+//------------------------------------------------------------------------------
+
+void UNROLL::Move(int X, int Y){
+    if(InBlock && !Unrolling) Block .Move(X, Y);
+    else                      Output->Move(X + OffsetX, Y + OffsetY);
+}
+//------------------------------------------------------------------------------
+
+void UNROLL::Draw(int X, int Y){
+    if(InBlock && !Unrolling) Block .Draw(X, Y);
+    else                      Output->Draw(X + OffsetX, Y + OffsetY);
+}
+//------------------------------------------------------------------------------
+
+// The centre offset is relative, so it stays the same
+void UNROLL::Arc(int X, int Y, int I, int J){
+    if(InBlock && !Unrolling) Block .Arc(X, Y, I, J);
+    else                      Output->Arc(X + OffsetX, Y + OffsetY, I, J);
+}
+//------------------------------------------------------------------------------
+
+void UNROLL::Circle(int X, int Y, int R){
+    if(InBlock && !Unrolling) Block .Circle(X, Y, R);
+    else                      Output->Circle(X + OffsetX, Y + OffsetY, R);
+}
+//------------------------------------------------------------------------------
+
+void UNROLL::StepRepeat(int CountX, int CountY, int StepX, int StepY){
+    if(InBlock) return; // Blocks cannot be nested
+
+    InBlock      = true;
+    this->CountX = CountX;
+    this->CountY = CountY;
+    this->StepX  = StepX;
+    this->StepY  = StepY;
+    Block.Clear();
+}
+//------------------------------------------------------------------------------
+
+void UNROLL::EndStepRepeat(){
+    if(!InBlock || Unrolling) return;
+
+    Unrolling = true;
+    for(int y = 0; y < CountY; y++){
+        for(int x = 0; x < CountX; x++){
+            OffsetX = x * StepX;
+            OffsetY = y * StepY;
+            Replay(Block.Data(), Block.Length(), this);
+        }
+    }
+    Unrolling = false;
+    OffsetX   = OffsetY = 0;
+    InBlock   = false;
+    Block.Clear();
+}
+//------------------------------------------------------------------------------
+
+// Passes an unfinished block on as it stands
+bool UNROLL::Flush(){
+    if(InBlock) EndStepRepeat();
+    return Output->Flush();
+}
+//------------------------------------------------------------------------------
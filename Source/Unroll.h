@@ -0,0 +1,60 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Unroll_h
+#define Unroll_h
+//------------------------------------------------------------------------------
+
+#include "Filter.h"
+#include "Record.h"
+//------------------------------------------------------------------------------
+
+// Replaces step-and-repeat blocks by every copy of their content, for
+// outputs that cannot express them.  Blocks are recorded in memory, and
+// passed on when they end.
+class UNROLL: public FILTER{
+    private:
+        RECORDER Block;
+        bool     InBlock;
+        bool     Unrolling;
+        int      CountX, CountY;
+        int      StepX,  StepY;
+        int      OffsetX, OffsetY; // Of the copy being passed on
+
+    public:
+        UNROLL(PLOTTER* Output);
+
+        void End          ();
+        void Select       (int Code);
+        void Linear       ();
+        void Circular     (bool CCW);
+        void Flash        (int X, int Y);
+        void Move         (int X, int Y);
+        void Draw         (int X, int Y);
+        void Arc          (int X, int Y, int I, int J);
+        void Circle       (int X, int Y, int R);
+        void StepRepeat   (int CountX, int CountY, int StepX, int StepY);
+        void EndStepRepeat();
+        bool Flush        ();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,127 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#include "Writer.h"
+//------------------------------------------------------------------------------
+
+const char WRITER::DigitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+//------------------------------------------------------------------------------
+
+// Room for the longest integer, including sign and leading zero
+static const size_t Margin = 16;
+//------------------------------------------------------------------------------
+
+WRITER::WRITER(size_t Size){
+    if(Size < 4*Margin) Size = 4*Margin;
+
+    Sink     = 0;
+    Buffer   = new char[Size];
+    Position = Buffer;
+    Limit    = Buffer + Size - Margin;
+    Failed   = false;
+}
+//------------------------------------------------------------------------------
+
+WRITER::~WRITER(){
+    delete[] Buffer;
+}
+//------------------------------------------------------------------------------
+
+void WRITER::Open(SINK* Sink){
+    this->Sink = Sink;
+    Position   = Buffer;
+    Failed     = false;
+}
+//------------------------------------------------------------------------------
+
+void WRITER::Drain(){
+    if(Position > Buffer){
+        STOPWATCH Watch;
+        if(!Sink || !Sink->Write(Buffer, Position - Buffer)) Failed = true;
+        Watch.Split(OutputTime());
+    }
+    Position = Buffer;
+}
+//------------------------------------------------------------------------------
+
+void WRITER::String(const char* Data, size_t Length){
+    while(Length){
+        size_t Count = Limit + Margin - Position;
+        if(Count > Length) Count = Length;
+
+        memcpy(Position, Data, Count);
+        Position += Count;
+        Data     += Count;
+        Length   -= Count;
+
+        if(Position >= Limit) Drain();
+    }
+}
+//------------------------------------------------------------------------------
+
+void WRITER::Decimal(int Value, int FractionDigits){
+    char Digits[16];
+    int  Count = 0;
+
+    unsigned u = Value;
+    if(Value < 0){
+        Char('-');
+        u = 0 - u;
+    }
+    do{
+        Digits[Count++] = '0' + u % 10;
+        u /= 10;
+    }while(u || Count <= FractionDigits);
+
+    while(Count > FractionDigits) Char(Digits[--Count]);
+    if(Count){
+        Char('.');
+        while(Count) Char(Digits[--Count]);
+    }
+}
+//------------------------------------------------------------------------------
+
+void WRITER::Real(double Value){
+    char Digits[32];
+    int  Length = snprintf(Digits, sizeof(Digits), "%.10g", Value);
+    if(Length > 0) String(Digits, Length);
+}
+//------------------------------------------------------------------------------
+
+bool WRITER::Flush(){
+    Drain();
+
+    STOPWATCH Watch;
+    if(Sink && !Sink->Flush()) Failed = true;
+    Watch.Split(OutputTime());
+
+    return !Failed;
+}
+//------------------------------------------------------------------------------
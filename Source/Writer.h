@@ -0,0 +1,111 @@
+//==============================================================================
+// Copyright (C) John-Philip Taylor
+// jpt13653903@gmail.com
+//
+// This file is part of Drill2Gerber
+//
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+//==============================================================================
+
+#ifndef Writer_h
+#define Writer_h
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Statistics.h"
+#include "Stream.h"
+//------------------------------------------------------------------------------
+
+// Buffered output with hand-rolled integer formatting.  Data is passed to the
+// sink in large blocks, and the buffer is reused for the whole conversion.
+// The time spent in the sink is added to the OutputTime of the thread.
+class WRITER{
+    private:
+        static const char DigitPairs[201];
+
+        SINK* Sink;
+        char* Buffer;
+        char* Position;
+        char* Limit;    // Leaves room for one formatted integer
+        bool  Failed;
+
+        void Drain();
+
+    public:
+        WRITER(size_t Size = 0x40000);
+       ~WRITER();
+
+        void Open(SINK* Sink);
+
+        inline void Char(char c){
+            *Position++ = c;
+            if(Position >= Limit) Drain();
+        }
+
+        void String(const char* Data, size_t Length);
+
+        inline void String(const char* Data){
+            String(Data, strlen(Data));
+        }
+
+        // Equivalent to printf("%d")
+        inline void Int(int Value){
+            unsigned u = Value;
+            if(Value < 0){
+                *Position++ = '-';
+                u = 0 - u;
+            }
+
+            char  Digits[10];
+            char* End = Digits + sizeof(Digits);
+            char* p   = End;
+            while(u >= 100){
+                unsigned Pair = (u % 100) * 2;
+                u /= 100;
+                *--p = DigitPairs[Pair+1];
+                *--p = DigitPairs[Pair  ];
+            }
+            if(u >= 10){
+                *--p = DigitPairs[u*2+1];
+                *--p = DigitPairs[u*2  ];
+            }else{
+                *--p = '0' + u;
+            }
+            while(p < End) *Position++ = *p++;
+
+            if(Position >= Limit) Drain();
+        }
+
+        // Equivalent to printf("%02d")
+        inline void Int2(int Value){
+            if(Value >= 0 && Value < 10) *Position++ = '0';
+            Int(Value);
+        }
+
+        // A fixed-point integer with the given number of fraction digits,
+        // such as a coordinate in the file units
+        void Decimal(int Value, int FractionDigits);
+
+        // Equivalent to printf("%.10g"), for values that are not integers
+        void Real(double Value);
+
+        // Returns false if any write failed
+        bool Flush();
+};
+//------------------------------------------------------------------------------
+
+#endif
+//------------------------------------------------------------------------------
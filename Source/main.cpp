@@ -29,625 +29,1444 @@ static const char* BugReportString =
     "https://github.com/jpt13653903/Drill2Gerber/issues\n";
 //------------------------------------------------------------------------------
 
+// Only waits when run interactively, so never blocks a script or pipeline
 void Pause(){
+    if(!isatty(fileno(stdin)) || !isatty(fileno(stdout))) return;
     printf("\nPress Enter to continue\n");
     getchar();
 }
 //------------------------------------------------------------------------------
 
-bool ReadLine(){
-    int c;
-    int j = 0;
+// Command-line settings that apply to every file
+struct SETTINGS{
+    CONVERTER::OPTIONS Options;
+
+    bool   Pipeline;
+    bool   Dedupe;
+    double DedupeTolerance;   // mm
+    bool   Simplify;
+    double SimplifyTolerance; // mm
+    bool   Reorder;
+
+    // Panel of Columns by Rows boards
+    bool   Panel;
+    int    Columns, Rows;
+    double PitchX, PitchY; // mm
+    int    Rotation;       // Degrees counter-clockwise
+
+    std::string CacheDirectory; // Empty when not caching
+
+    // Bitmap of the output, "<OutputFile>.png" or ".pgm"
+    bool   Preview;
+    bool   Png;
+    double Dpi;
+
+    // Other formats, written from the same conversion to "<OutputFile>.svg",
+    // ".dxf" and ".csv"
+    bool Svg;
+    bool Dxf;
+    bool Csv;
+
+    bool Statistics;
+    bool Json; // Statistics as one JSON object per file
+
+    bool Gzip;  // Compress the output, even if the input is not compressed
+    bool Merge; // Merge all the inputs into one output
+    bool Split; // Write every tool to its own file
+    bool Watch; // Reconvert the inputs whenever they change
+    int  MaxOpen; // Split output files open at a time, per input
+
+    // Empty for "<InputFile>.grb", or "-" for stdout
+    std::string OutputFile;
+
+    // Conversion server, at a Unix domain socket or "-" for stdin and stdout
+    std::string     Serve;
+    SERVER::LIMITS  Limits;
+    std::string     Client;      // Convert through the server at the socket
+    std::string     LoadTest;    // Load test the server at the socket
+    long long       Requests;    // Of the load test
+    int             Connections; // Of the load test
+
+    SETTINGS(){
+        Gzip              = false;
+        Merge             = false;
+        Split             = false;
+        Watch             = false;
+        Requests          = 1000;
+        Connections       = 0;
+        MaxOpen           = 32;
+        Statistics        = false;
+        Json              = false;
+        Pipeline          = false;
+        Dedupe            = false;
+        DedupeTolerance   = 0;
+        Simplify          = false;
+        Reorder           = false;
+        Panel             = false;
+        Preview           = false;
+        Png               = true;
+        Dpi               = 300;
+        Svg               = false;
+        Dxf               = false;
+        Csv               = false;
+        Columns           = 1;
+        Rows              = 1;
+        PitchX            = 0;
+        PitchY            = 0;
+        Rotation          = 0;
+        SimplifyTolerance = 0;
+    }
+};
+//------------------------------------------------------------------------------
 
-    c = fgetc(Input);
-    if(c == EOF) return false;
+// File extensions picked up when a directory is given as input
+static const char* DrillExtensions[] = {
+    ".drl", ".drd", ".txt", ".xln", ".exc", ".tap", ".nc", 0
+};
+//------------------------------------------------------------------------------
 
-    while(c != EOF){
-        if(c == '\n'){
-            Line[j] = 0;
-            return true;
-        }
-        if(c != '\r') Line[j++] = c;
-        c = fgetc(Input);
-    }
-    Line[j] = 0;
-    return true;
+static bool IsDirectory(const std::string& Path){
+    struct stat Info;
+    if(stat(Path.c_str(), &Info)) return false;
+    return S_ISDIR(Info.st_mode);
 }
 //------------------------------------------------------------------------------
 
-bool IsLine(const char* String){
-    int j;
-    for(j = 0; Line[j] && String[j]; j++){
-        if(Line[j] != String[j]) return false;
+// Case insensitive
+static bool EndsWith(const std::string& Name, size_t End, const char* Extension){
+    size_t Length = strlen(Extension);
+    if(End <= Length) return false;
+
+    const char* Tail = Name.c_str() + End - Length;
+    for(size_t n = 0; n < Length; n++){
+        if(tolower(Tail[n]) != Extension[n]) return false;
     }
-    if(String[j]       ) return false; // Still characters left
-    if(Line  [j] >= ' ') return false; // Still printable characters left
     return true;
 }
 //------------------------------------------------------------------------------
 
-bool Keyword(int* Index, const char* String){
-    int j;
+// The length of the name without a ".gz" extension
+static size_t StripGzip(const std::string& Name){
+    if(EndsWith(Name, Name.length(), ".gz")) return Name.length() - 3;
+    return Name.length();
+}
+//------------------------------------------------------------------------------
 
-    for(j = 0; Line[*Index+j] && String[j]; j++){
-        if(Line[*Index+j] != String[j]) return false;
+// Also accepts compressed files, with ".gz" after the drill extension
+static bool IsDrillFile(const std::string& Name){
+    size_t End = StripGzip(Name);
+
+    for(int n = 0; DrillExtensions[n]; n++){
+        if(EndsWith(Name, End, DrillExtensions[n])) return true;
     }
-    if(String[j]) return false; // Still characters left
+    return false;
+}
+//------------------------------------------------------------------------------
 
-    *Index += j;
-    return true;
+// Matches '*' and '?' wildcards
+static bool Match(const char* Pattern, const char* Name){
+    while(*Pattern){
+        if(*Pattern == '*'){
+            Pattern++;
+            for(; *Name; Name++){
+                if(Match(Pattern, Name)) return true;
+            }
+            return !*Pattern;
+        }
+        if(!*Name) return false;
+        if(*Pattern != '?' && *Pattern != *Name) return false;
+        Pattern++;
+        Name   ++;
+    }
+    return !*Name;
 }
 //------------------------------------------------------------------------------
 
-int GetTool(int* ToolChars, int Index = 1){
-    int j;
-    int Tool = 0;
+// Adds the regular files in Directory of which the names match Pattern, or
+// that look like drill files if Pattern is null
+static void AddDirectory(
+    const std::string&        Directory,
+    const char*               Pattern,
+    std::vector<std::string>& Files
+){
+    DIR* Dir = opendir(Directory.empty() ? "." : Directory.c_str());
+    if(!Dir) return;
+
+    std::vector<std::string> Found;
+    struct dirent* Entry;
+    while((Entry = readdir(Dir))){
+        if(Entry->d_name[0] == '.') continue;
+
+        if(Pattern){
+            if(!Match(Pattern, Entry->d_name)) continue;
+        }else{
+            if(!IsDrillFile(Entry->d_name)) continue;
+        }
 
-    for(j = Index; Line[j] >= '0' && Line[j] <= '9'; j++){
-        Tool = 10*Tool + Line[j] - '0';
+        std::string Path = Directory + Entry->d_name;
+        if(!IsDirectory(Path)) Found.push_back(Path);
     }
+    closedir(Dir);
 
-    *ToolChars = j-Index;
-    return Tool;
+    std::sort(Found.begin(), Found.end());
+    Files.insert(Files.end(), Found.begin(), Found.end());
 }
 //------------------------------------------------------------------------------
 
-/* The drill file format supports a maximum of 6 digits:
+// Expands an argument into input files.  The argument can be a file, a
+// directory, a wildcard pattern or "@list_file", with one name per line.
+// Returns false if nothing was found.
+static bool AddInput(const char* Argument, std::vector<std::string>& Files){
+    size_t Count = Files.size();
+
+    if(Argument[0] == '@'){
+        FILE* List = fopen(Argument+1, "r");
+        if(!List){
+            printf("Cannot open \"%s\" for reading\n", Argument+1);
+            return false;
+        }
+        char Buffer[0x1000];
+        while(fgets(Buffer, sizeof(Buffer), List)){
+            int j = strlen(Buffer);
+            while(j > 0 && (unsigned char)Buffer[j-1] <= ' ') Buffer[--j] = 0;
+            if(j) AddInput(Buffer, Files);
+        }
+        fclose(List);
 
-https://web.archive.org/web/20071030075236/http://www.excellon.com/manuals/program.htm */
+    }else if(strpbrk(Argument, "*?")){
+        std::string Directory(Argument);
+        size_t Slash = Directory.find_last_of("/\\");
+        if(Slash == std::string::npos) Directory.clear();
+        else                           Directory.resize(Slash+1);
+        AddDirectory(Directory, Argument + Directory.length(), Files);
 
-int ConvertCoord(int Index, int* ValueOut){
-    int  Value         = 0;
-    int  Digits        = 0;
-    int  PointPos      = 0;
-    bool Sign          = false;
-    bool ExplicitPoint = false;
+    }else if(IsDirectory(Argument)){
+        std::string Directory(Argument);
+        char Last = Directory[Directory.length()-1];
+        if(Last != '/' && Last != '\\') Directory += '/';
+        AddDirectory(Directory, 0, Files);
 
-    int j = Index;
-    if(Line[j] == '+'){
-        j++;
-    }else if(Line[j] == '-'){
-        Sign = true;
-        j++;
+    }else{
+        Files.push_back(Argument);
     }
 
-    while(Line[j]){
-        if(Line[j] >= '0' && Line[j] <= '9'){
-            Value = 10*Value + Line[j] - '0';
-            Digits  ++;
-            PointPos++;
-
-        }else if(Line[j] == '.'){
-            ExplicitPoint = true;
-            PointPos      = 0;
-
-        }else{
-            break;
-        }
-        j++;
+    if(Files.size() == Count){
+        printf("No input files found for \"%s\"\n", Argument);
+        return false;
     }
+    return true;
+}
+//------------------------------------------------------------------------------
 
-    // Get the real value (scaled with 10^FractionDigits)
-    if(ExplicitPoint){
-        while(PointPos < FractionDigits){
-            Value *= 10;
-            Digits  ++;
-            PointPos++;
+// Formats the diagnostics and returns the exit code: 3 if the conversion
+// failed, or 2 if it succeeded but not every output could be written.  The
+// bug report text is only added for unsupported input, or for a failure
+// without an error to explain it.
+static int Report(
+    const std::vector<DIAGNOSTIC>& Diagnostics,
+    bool                           Success,
+    bool                           Written,
+    std::string&                   Log
+){
+    bool Unsupported = false;
+    bool Explained   = false;
+    char Buffer[0x40];
+
+    for(size_t n = 0; n < Diagnostics.size(); n++){
+        const DIAGNOSTIC& Diagnostic = Diagnostics[n];
+
+        if(Diagnostic.Level == DIAGNOSTIC::Error) Log += "Error";
+        else                                      Log += "Warning";
+
+        if(Diagnostic.LineNumber){
+            sprintf(Buffer, " on line %d", Diagnostic.LineNumber);
+            Log += Buffer;
         }
+        Log += ": " + Diagnostic.Message + "\n";
 
-    // If leading zeros are specified, add the trailing ones
-    }else if(LeadingZeros){
-        while(Digits < (IntDigits + FractionDigits)){
-            Value *= 10;
-            Digits++;
-        }
+        if(Diagnostic.Unsupported) Unsupported = true;
+        if(Diagnostic.Level == DIAGNOSTIC::Error) Explained = true;
     }
 
-    j -= Index;
-    if(j == 0){ // Prevent infinite loop
-        printf("\nError while converting coordinate\n\n");
-        Error = true;
-        j++;
+    if(Unsupported || (!Success && !Explained)){
+        Log += "\n";
+        Log += BugReportString;
     }
+    if(!Success) return 3;
 
-    // Output is always with trailing zeros
-    *ValueOut = Sign ? -Value : Value;
-    return j;
+    if(!Written){
+        Log += "Drill to Gerber conversion successful, but not every output was written\n";
+        return 2;
+    }
+    Log += "Drill to Gerber conversion successful\n";
+    return 0;
 }
 //------------------------------------------------------------------------------
 
-void GetFormat(int Index){
-    IntDigits = 0;
-    while(Line[Index] == '0'){
-        Index++;
-        IntDigits++;
+// Lists the number of duplicates removed per tool
+static void ReportDuplicates(const DEDUPE& Dedupe, std::string& Log){
+    long long Total = 0;
+    std::string List;
+    char Buffer[0x40];
+
+    for(auto& Tool: Dedupe.Removed){
+        sprintf(Buffer, "%sT%d: %lld", List.empty() ? "" : ", ", Tool.first-10, Tool.second);
+        List  += Buffer;
+        Total += Tool.second;
+    }
+    sprintf(Buffer, "Removed %lld duplicate hits", Total);
+    Log += Buffer;
+    if(Total) Log += " (" + List + ")";
+    Log += "\n";
+}
+//------------------------------------------------------------------------------
+
+// Reports the reduction in route segments
+static void ReportSimplified(const SIMPLIFY& Simplify, std::string& Log){
+    char Buffer[0x80];
+    long long In  = Simplify.SegmentsIn;
+    long long Out = Simplify.SegmentsOut;
+
+    sprintf(Buffer, "Simplified %lld route segments to %lld", In, Out);
+    Log += Buffer;
+    if(In){
+        sprintf(Buffer, " (%.1f%% fewer)", 100.0 * (In - Out) / In);
+        Log += Buffer;
     }
+    Log += "\n";
+}
+//------------------------------------------------------------------------------
 
-    if(Line[Index] != '.') return;
-    Index++;
+// Reports the reduction in aperture changes and travel between hits
+static void ReportReordered(const REORDER& Reorder, std::string& Log){
+    char Buffer[0x100];
+    double In  = Reorder.TravelIn;
+    double Out = Reorder.TravelOut;
 
-    FractionDigits = 0;
-    while(Line[Index] == '0'){
-        Index++;
-        FractionDigits++;
+    sprintf(Buffer,
+        "Reordered %lld hits: %lld aperture changes to %lld, "
+        "travel %.1f mm to %.1f mm",
+        Reorder.HitsReordered, Reorder.SelectsIn, Reorder.SelectsOut, In, Out
+    );
+    Log += Buffer;
+    if(In > 0){
+        if(Out <= In) sprintf(Buffer, " (%.1f%% less)", 100.0 * (In - Out) / In);
+        else          sprintf(Buffer, " (%.1f%% more)", 100.0 * (Out - In) / In);
+        Log += Buffer;
     }
+    Log += "\n";
 }
 //------------------------------------------------------------------------------
 
-// Arcs are guaranteed to be less than 180 deg
-void DoArc(double pX, double pY, double X, double Y, double R, bool CCW){
-    double x = X - pX;
-    double y = Y - pY;
+// The outcome of converting one file
+struct RESULT{
+    bool      Success;
+    bool      Cached;
+    long long BytesIn; // Before decompression
+
+    std::vector<DIAGNOSTIC> Diagnostics;
+    STATISTICS              Statistics;
+
+    RESULT(){
+        Success = false;
+        Cached  = false;
+        BytesIn = 0;
+    }
+};
+//------------------------------------------------------------------------------
+
+// Converts the input into the plotter, using the cache if there is one.  On
+// a hit, the input is not parsed at all.
+static void Convert(
+    READER*         Reader,
+    PLOTTER*        Plotter,
+    const SETTINGS& Settings,
+    THREAD_POOL*    Pool,
+    RESULT&         Result,
+    std::string&    Log
+){
+    CONVERTER Converter;
+    Converter.Options = Settings.Options;
+
+    const char* Data;
+    size_t      Length, Offset;
+
+    if(Settings.CacheDirectory.empty() || !Reader->GetData(&Data, &Length, &Offset)){
+        if(Settings.Pipeline) Result.Success = Converter.ConvertPipelined(Reader, Plotter);
+        else                  Result.Success = Converter.Convert(Reader, Plotter, Pool);
+        Result.Diagnostics = Converter.Diagnostics;
+        Result.Statistics  = Converter.Statistics;
+        return;
+    }
+
+    CACHE Cache(Settings.CacheDirectory);
+    MODEL Model;
 
-    double e = CCW ? 1 : -1;
-    double d = x*x + y*y;
-    double h = R*R - d/4.0;
+    STOPWATCH Watch;
+    uint64_t  Key = CACHE::GetKey(Data, Length, Settings.Options);
 
-    if(h <= 0.0){ // Invalid radius
-        x = (X - pX)/2.0;
-        y = (Y - pY)/2.0;
+    if(Cache.Load(Key, &Model)){
+        Log += "Loaded from the cache\n";
+        Result.Cached = true;
+        Result.Statistics.Add(Model.Statistics);
+        Watch.Split(Result.Statistics.Read);
 
     }else{
-        d = sqrt(d);
-        h = sqrt(h);
+        if(Settings.Pipeline) Converter.ConvertPipelined(Reader, &Model);
+        else                  Converter.Convert(Reader, &Model, Pool);
+        Model.SetResult(Converter);
+        Model.Key = Key;
 
-        x = (X - pX)/2.0 - e * h * ((Y - pY) / d);
-        y = (Y - pY)/2.0 + e * h * ((X - pX) / d);
+        if(!Model.Error && !Cache.Store(Model)){
+            Log += "Warning: Cannot write to the cache\n";
+        }
+        Result.Statistics = Converter.Statistics;
+        Watch = STOPWATCH();
     }
 
-    fprintf(Output,
-        "X%dY%dI%dJ%dD01*\n",
-        (int)round(X), (int)round(Y),
-        (int)round(x), (int)round(y)
-    );
+    Model.Replay(Plotter);
+    Result.Diagnostics = Model.Diagnostics;
+    Result.Success     = !Model.Error;
+
+    if(!Plotter->Flush() && !Model.Error){
+        DIAGNOSTIC Diagnostic;
+        Diagnostic.Level       = DIAGNOSTIC::Error;
+        Diagnostic.LineNumber  = 0;
+        Diagnostic.Unsupported = false;
+        Diagnostic.Message     = "Cannot write to the output";
+        Result.Diagnostics.push_back(Diagnostic);
+        Result.Success = false;
+    }
+    Watch.Split(Result.Statistics.Emit);
 }
 //------------------------------------------------------------------------------
 
-void DoCoord(int Index){
-    // These are used for circular routing
-    static int X = 0, Y = 0, I = 0, J = 0, R = 0;
-
-    // Used to detect if this sets arc parameters, or includes a routing command
-    bool ParameterOnly = false;
-
-    if(!ToolSelected){
-        fprintf(Output, "D%02d*\n", Tool+10);
-        ToolSelected = true;
-    }
-
-    while(Line[Index]){
-        switch(Line[Index]){
-            case 'X':
-                ParameterOnly = false;
-                Index ++;
-                Index += ConvertCoord(Index, &X);
-                break;
-
-            case 'Y':
-                ParameterOnly = false;
-                Index ++;
-                Index += ConvertCoord(Index, &Y);
-                break;
-
-            case 'I':
-                if(Index == 0) ParameterOnly = true;
-                Index ++;
-                Index += ConvertCoord(Index, &I);
-                R = round(sqrt((double)I*(double)I + (double)J*(double)J));
-                break;
-
-            case 'J':
-                if(Index == 0) ParameterOnly = true;
-                Index ++;
-                Index += ConvertCoord(Index, &J);
-                R = round(sqrt((double)I*(double)I + (double)J*(double)J));
-                break;
-
-            case 'A':
-                if(Index == 0) ParameterOnly = true;
-                Index ++;
-                Index += ConvertCoord(Index, &R);
-                break;
-
-            case 'G':
-                if(Line[Index+1] == '8' && Line[Index+2] == '5'){
-                    if(pX != X) fprintf(Output, "X%d", X);
-                    if(pY != Y) fprintf(Output, "Y%d", Y);
-                    fprintf(Output, "D02*\n");
-                    pX = X;
-                    pY = Y;
-
-                    Z_Axis = Z_Routing;
-                    Mode   = Mode_Route_Linear;
-                    DoCoord(Index+3);
-                    Z_Axis = Z_Retracted;
-                    Mode   = Mode_Drill;
-                }else{
-                    printf("\nInvalid embedded G-command\n\n");
-                    Error = true;
-                }
-                return;
+static void ReportPhase(const char* Name, const PHASE_TIME& Phase, std::string& Log){
+    char Buffer[0x80];
+    sprintf(Buffer, "  %-7s %9.3f %9.3f\n", Name, Phase.Wall, Phase.CPU);
+    Log += Buffer;
+}
+//------------------------------------------------------------------------------
+
+static void ReportCodes(
+    const char*                             Name,
+    const std::map<std::string, long long>& Codes,
+    std::string&                            Log
+){
+    char Buffer[0x40];
+
+    if(Codes.empty()) return;
 
-            default:
-                Line[Index] = 0;
-                break;
+    Log += "  ";
+    Log += Name;
+    for(auto& Code: Codes){
+        sprintf(Buffer, " %s (%lld)", Code.first.c_str(), Code.second);
+        Log += Buffer;
+    }
+    Log += "\n";
+}
+//------------------------------------------------------------------------------
+
+// Lists the phase times, the sizes and the counters in a table
+static void ReportStatistics(
+    const RESULT& Result,
+    double        Time,
+    long long     BytesIn,
+    long long     BytesOut,
+    std::string&  Log
+){
+    const STATISTICS& Statistics = Result.Statistics;
+    char Buffer[0x100];
+
+    Log += "Statistics:\n";
+    Log += "  Phase    Wall (s)   CPU (s)\n";
+    ReportPhase("Read",  Statistics.Read,  Log);
+    ReportPhase("Parse", Statistics.Parse, Log);
+    ReportPhase("Emit",  Statistics.Emit,  Log);
+    sprintf(Buffer, "  %-7s %9.3f\n", "Total", Time);
+    Log += Buffer;
+
+    sprintf(Buffer, "  Input   %lld bytes", BytesIn);
+    Log += Buffer;
+    if(Time > 0){
+        sprintf(Buffer, " (%.1f MB/s)", BytesIn / Time * 1e-6);
+        Log += Buffer;
+    }
+    sprintf(Buffer, "\n  Output  %lld bytes\n", BytesOut);
+    Log += Buffer;
+
+    if(!Statistics.Tools.empty()){
+        Log += "  Tool         Hits    Slots   Routes     Arcs  Repeats\n";
+        for(auto& Tool: Statistics.Tools){
+            const TOOL_COUNTS& Counts = Tool.second;
+            sprintf(Buffer, "  T%-5d %10lld %8lld %8lld %8lld %8lld\n",
+                Tool.first,
+                Counts.Hits, Counts.Slots, Counts.Routes, Counts.Arcs, Counts.Repeats
+            );
+            Log += Buffer;
         }
     }
+    ReportCodes("Unsupported codes:", Statistics.Unsupported, Log);
+    ReportCodes("Ignored codes:",     Statistics.Ignored,     Log);
+}
+//------------------------------------------------------------------------------
 
-    if(ParameterOnly){
-        pX = X;
-        pY = Y;
-        return;
+static std::string JsonString(const std::string& String){
+    std::string Result = "\"";
+    char Buffer[8];
+
+    for(size_t n = 0; n < String.length(); n++){
+        unsigned char c = String[n];
+        if(c == '"' || c == '\\'){
+            Result += '\\';
+            Result += c;
+        }else if(c < ' '){
+            sprintf(Buffer, "\\u%04x", c);
+            Result += Buffer;
+        }else{
+            Result += c;
+        }
     }
+    return Result + "\"";
+}
+//------------------------------------------------------------------------------
 
-    switch(Mode){
-        case Mode_Drill:
-            if(pX != X) fprintf(Output, "X%d", X);
-            if(pY != Y) fprintf(Output, "Y%d", Y);
-            fprintf(Output, "D03*\n");
-            break;
-
-        case Mode_Route_Canned_CW:
-        case Mode_Route_Canned_CCW:
-            fprintf(Output, "X%dY%dD02*\n", X+R, Y);
-            fprintf(Output, "I%dJ0D01*\n" ,  -R   );
-            fprintf(Output, "X%dY%dD02*\n", X  , Y);
-            break;
-
-        default:
-            if(Z_Axis == Z_Routing){
-                switch(Mode){
-                    case Mode_Route_Move:
-                    case Mode_Route_Linear:
-                        if(pX != X) fprintf(Output, "X%d", X);
-                        if(pY != Y) fprintf(Output, "Y%d", Y);
-                        fprintf(Output, "D01*\n");
-                        break;
-
-                    case Mode_Route_CW:
-                        DoArc(pX, pY, X, Y, R, false);
-                        break;
-
-                    case Mode_Route_CCW:
-                        DoArc(pX, pY, X, Y, R, true);
-                        break;
-
-                    default:
-                        break;
-                }
-            }else{ // Move only
-                if(pX != X) fprintf(Output, "X%d", X);
-                if(pY != Y) fprintf(Output, "Y%d", Y);
-                fprintf(Output, "D02*\n");
-            }
-            break;
+static std::string JsonPhase(const char* Name, const PHASE_TIME& Phase){
+    char Buffer[0x80];
+    sprintf(Buffer, "\"%s\":{\"wall\":%.6f,\"cpu\":%.6f}", Name, Phase.Wall, Phase.CPU);
+    return Buffer;
+}
+//------------------------------------------------------------------------------
+
+static std::string JsonCodes(const char* Name, const std::map<std::string, long long>& Codes){
+    std::string Result = "\"";
+    Result += Name;
+    Result += "\":{";
+
+    char Buffer[0x20];
+    for(auto& Code: Codes){
+        if(Result.back() != '{') Result += ",";
+        sprintf(Buffer, ":%lld", Code.second);
+        Result += JsonString(Code.first) + Buffer;
     }
+    return Result + "}";
+}
+//------------------------------------------------------------------------------
 
-    pX = X;
-    pY = Y;
+// Writes the statistics as a single-line JSON object, for collection by
+// other tools.  The objects are kept apart from the other messages, and
+// written to stdout on their own.
+static void ReportJson(
+    const std::string& InputFile,
+    const RESULT&      Result,
+    double             Time,
+    long long          BytesIn,
+    long long          BytesOut,
+    std::string&       Json
+){
+    const STATISTICS& Statistics = Result.Statistics;
+    char Buffer[0x100];
+
+    Json += "{\"file\":" + JsonString(InputFile);
+    sprintf(Buffer, ",\"success\":%s,\"cached\":%s,\"wall\":%.6f,",
+        Result.Success ? "true" : "false",
+        Result.Cached  ? "true" : "false",
+        Time
+    );
+    Json += Buffer;
+    Json += JsonPhase("read",  Statistics.Read ) + ",";
+    Json += JsonPhase("parse", Statistics.Parse) + ",";
+    Json += JsonPhase("emit",  Statistics.Emit );
+    sprintf(Buffer, ",\"bytes_in\":%lld,\"bytes_out\":%lld,\"tools\":{", BytesIn, BytesOut);
+    Json += Buffer;
+
+    bool First = true;
+    for(auto& Tool: Statistics.Tools){
+        const TOOL_COUNTS& Counts = Tool.second;
+        sprintf(Buffer,
+            "%s\"T%d\":{\"hits\":%lld,\"slots\":%lld,\"routes\":%lld,"
+            "\"arcs\":%lld,\"repeats\":%lld}",
+            First ? "" : ",", Tool.first,
+            Counts.Hits, Counts.Slots, Counts.Routes, Counts.Arcs, Counts.Repeats
+        );
+        Json += Buffer;
+        First = false;
+    }
+    Json += "}," + JsonCodes("unsupported", Statistics.Unsupported);
+    Json += ","  + JsonCodes("ignored",     Statistics.Ignored    ) + "}\n";
 }
 //------------------------------------------------------------------------------
 
-const char* GetToolDiameter(const char* s){
-    static char Result[0x100];
+// Opens the input, where "-" is stdin
+static bool OpenInput(const std::string& InputFile, READER& Reader, std::string& Log){
+    if(InputFile == "-"){
+        #ifdef _WIN32
+            _setmode(_fileno(stdin), _O_BINARY);
+        #endif
+        Reader.Open(stdin);
+        return true;
+    }
+    if(!Reader.Open(InputFile.c_str())){
+        Log += "Cannot open \"" + InputFile + "\" for reading\n";
+        return false;
+    }
+    return true;
+}
+//------------------------------------------------------------------------------
 
-    int n, r;
+// Takes the size of the input from the reader, which also counts pipes, and
+// fails the conversion if the input could not be decompressed
+static void CheckInput(const READER& Reader, RESULT& Result){
+    Result.BytesIn = Reader.BytesRead();
+    if(!Reader.Failed()) return;
+
+    DIAGNOSTIC Diagnostic;
+    Diagnostic.Level       = DIAGNOSTIC::Error;
+    Diagnostic.LineNumber  = 0;
+    Diagnostic.Unsupported = false;
+    Diagnostic.Message     = "The compressed input is corrupt or truncated";
+    Result.Diagnostics.push_back(Diagnostic);
+    Result.Success = false;
+}
+//------------------------------------------------------------------------------
 
-    Result[0] = 0;
+// Opens the output, where "-" is stdout
+static FILE* OpenOutput(const std::string& OutputFile, bool Compressed, std::string& Log){
+    if(OutputFile == "-"){
+        #ifdef _WIN32
+            if(Compressed) _setmode(_fileno(stdout), _O_BINARY);
+        #endif
+        return stdout;
+    }
+    FILE* Output = fopen(OutputFile.c_str(), Compressed ? "wb" : "w");
+    if(!Output) Log += "Cannot open \"" + OutputFile + "\" for writing\n";
+    return Output;
+}
+//------------------------------------------------------------------------------
 
-    n = 0;
-    while(s[n]){
-        if(s[n] == 'C'){
-            n++;
-            break;
-        }
-        n++;
+// Returns false if not everything could be written
+static bool CloseOutput(FILE* Output){
+    if(Output == stdout) return !fflush(Output);
+    return !fclose(Output);
+}
+//------------------------------------------------------------------------------
+
+// A file written next to the output, with the extension instead of ".grb"
+static std::string SideFile(
+    const std::string& OutputFile,
+    const SETTINGS&    Settings,
+    const char*        Extension
+){
+    std::string Name = OutputFile.substr(0, StripGzip(OutputFile));
+    if(!Settings.Split && EndsWith(Name, Name.length(), ".grb")){
+        Name.resize(Name.length() - 4);
     }
-    r = 0;
-    while(s[n] && r < 0xFF){
-        if((s[n] >= '0' && s[n] <= '9') || s[n] == '.') Result[r++] = s[n++];
-        else break;
+    return Name + Extension;
+}
+//------------------------------------------------------------------------------
+
+// A file of another format, written alongside the Gerber output
+struct FORMAT_FILE{
+    bool        Enabled;
+    std::string Name;
+    FILE*       File;
+    FILE_SINK   Sink;
+
+    FORMAT_FILE(bool Enabled, const std::string& Name):
+        Enabled(Enabled),
+        Name   (Name),
+        File   (Enabled ? fopen(Name.c_str(), "w") : 0),
+        Sink   (File){}
+
+   ~FORMAT_FILE(){
+        if(File) fclose(File);
     }
-    Result[r] = 0;
-    return Result;
+
+    // Returns false if not everything could be written
+    bool Close(){
+        FILE* Closing = File;
+        File = 0;
+        return !fclose(Closing);
+    }
+};
+//------------------------------------------------------------------------------
+
+// Renders the preview and writes it to the file
+static bool WritePreview(
+    PREVIEW&           Preview,
+    const std::string& PreviewFile,
+    const SETTINGS&    Settings,
+    THREAD_POOL*       Pool,
+    std::string&       Log
+){
+    auto Start = std::chrono::steady_clock::now();
+
+    if(!Preview.Render(Pool)){
+        Log += "The preview is too large; use a lower resolution (--dpi)\n";
+        return false;
+    }
+
+    FILE* File = fopen(PreviewFile.c_str(), "wb");
+    if(!File){
+        Log += "Cannot open \"" + PreviewFile + "\" for writing\n";
+        return false;
+    }
+    bool Written = Settings.Png ? Preview.WritePng(File) : Preview.WritePgm(File);
+    if(fclose(File) || !Written){
+        Log += "Cannot write \"" + PreviewFile + "\"\n";
+        return false;
+    }
+
+    std::chrono::duration<double> Time = std::chrono::steady_clock::now() - Start;
+
+    char Buffer[0x100];
+    sprintf(Buffer, "Rendered %zu primitives to a %d x %d preview in %.3f s\n",
+        Preview.Primitives(), Preview.Width, Preview.Height, Time.count());
+    Log += Buffer;
+    return true;
 }
 //------------------------------------------------------------------------------
 
-void DoRepeat(){
-    int dX = 0, dY = 0;
-    int Count = 0;
-    int Index = 0;
+// Converts one file to "<InputFile>.grb" and returns the exit code.  Large
+// files are split over the threads in the pool, if any, unless the
+// conversion is pipelined.  A compressed "<Name>.gz" input is converted to a
+// compressed "<Name>.grb.gz".
+//
+// The input "-" is stdin, which is converted to stdout by default.  Neither
+// is ever seeked, so both can be pipes.
+//
+// When splitting, every tool is written to "<OutputFile>.T<Tool>.grb"
+// instead, where the output file defaults to the input name.
+//
+// The preview, if any, is written to "<OutputFile>.png" (or ".pgm"), without
+// the ".grb".  So are the other formats, from the same conversion, with their
+// own extensions.
+//
+// An incremental converter, if given, converts memory-backed inputs instead
+// of a new one, resuming where it left off if the input was appended to.
+static int ConvertFile(
+    const std::string& InputFile,
+    const SETTINGS&    Settings,
+    THREAD_POOL*       Pool,
+    std::string&       Log,
+    std::string&       Json,
+    INCREMENTAL*       Incremental = 0
+){
+    auto Start = std::chrono::steady_clock::now();
+
+    READER Reader;
+    if(!OpenInput(InputFile, Reader, Log)) return 1;
+
+    std::string OutputFile = Settings.OutputFile;
+    bool        Compressed = Settings.Gzip;
+
+    if(Settings.Split){
+        if(OutputFile.empty()) OutputFile = InputFile.substr(0, StripGzip(InputFile));
+
+        // Every file gets its own ".grb", and is not compressed
+        OutputFile.resize(StripGzip(OutputFile));
+        if(EndsWith(OutputFile, OutputFile.length(), ".grb")){
+            OutputFile.resize(OutputFile.length() - 4);
+        }
+        if(OutputFile == "-"){
+            Log += "Split output needs a file name (-o)\n";
+            return 2;
+        }
+        Compressed = false;
 
-    if(!ToolSelected){
-        fprintf(Output, "D%02d*\n", Tool+10);
-        ToolSelected = true;
+    }else if(OutputFile.empty()){
+        if(InputFile == "-"){
+            OutputFile = "-";
+        }else{
+            if(Reader.IsCompressed()) Compressed = true;
+            OutputFile = InputFile.substr(0, StripGzip(InputFile)) + ".grb";
+            if(Compressed) OutputFile += ".gz";
+        }
+    }else if(StripGzip(OutputFile) < OutputFile.length()){
+        Compressed = true;
     }
 
-    while(Line[Index]){
-        switch(Line[Index]){
-            case 'X':
-                Index ++;
-                Index += ConvertCoord(Index, &dX);
-                break;
+    // The other formats are opened first, so that nothing is left open when
+    // one cannot be
+    FORMAT_FILE SvgFile(Settings.Svg, SideFile(OutputFile, Settings, ".svg"));
+    FORMAT_FILE DxfFile(Settings.Dxf, SideFile(OutputFile, Settings, ".dxf"));
+    FORMAT_FILE CsvFile(Settings.Csv, SideFile(OutputFile, Settings, ".csv"));
+    for(auto Format: {&SvgFile, &DxfFile, &CsvFile}){
+        if(Format->Enabled && !Format->File){
+            Log += "Cannot open \"" + Format->Name + "\" for writing\n";
+            return 2;
+        }
+    }
 
-            case 'Y':
-                Index ++;
-                Index += ConvertCoord(Index, &dY);
-                break;
+    FILE* Output = 0;
+    if(!Settings.Split){
+        Output = OpenOutput(OutputFile, Compressed, Log);
+        if(!Output) return 2;
+    }
 
-            case 'R':
-                Index ++;
-                while(Line[Index] >= '0' && Line[Index] <= '9'){
-                    Count *= 10;
-                    Count += Line[Index++] - '0';
-                }
-                break;
+    FILE_SINK Sink(Output);
+    GZIP_SINK Gzip(&Sink);
+
+    GERBER_WRITER Gerber;
+    if(Compressed) Gerber.Open(&Gzip);
+    else           Gerber.Open(&Sink);
+
+    SPLIT Split(OutputFile + ".T", ".grb", Settings.MaxOpen);
+
+    SVG_WRITER Svg;
+    DXF_WRITER Dxf;
+    CSV_WRITER Csv;
+    if(Settings.Svg) Svg.Open(&SvgFile.Sink);
+    if(Settings.Dxf) Dxf.Open(&DxfFile.Sink);
+    if(Settings.Csv) Csv.Open(&CsvFile.Sink);
+
+    // The chain of plotters, from the converter to the Gerber writer.  The
+    // other formats receive the same operations, with step-and-repeat blocks
+    // unrolled.
+    PLOTTER* Plotter = &Gerber;
+    if(Settings.Split) Plotter = &Split;
+    FANOUT   Formats;
+    UNROLL   Unroll(&Formats);
+    FANOUT   Fanout;
+    if(Settings.Svg || Settings.Dxf || Settings.Csv){
+        if(Settings.Svg) Formats.Add(&Svg);
+        if(Settings.Dxf) Formats.Add(&Dxf);
+        if(Settings.Csv) Formats.Add(&Csv);
+        Fanout.Add(Plotter);
+        Fanout.Add(&Unroll);
+        Plotter = &Fanout;
+    }
+    PREVIEW  Preview(Plotter, Settings.Dpi);
+    if(Settings.Preview) Plotter = &Preview;
+    PANEL    Panel(Plotter, Settings.Columns, Settings.Rows,
+                   Settings.PitchX, Settings.PitchY, Settings.Rotation);
+    if(Settings.Panel) Plotter = &Panel;
+    REORDER  Reorder(Plotter);
+    if(Settings.Reorder) Plotter = &Reorder;
+    SIMPLIFY Simplify(Plotter, Settings.SimplifyTolerance);
+    if(Settings.Simplify) Plotter = &Simplify;
+    DEDUPE   Dedupe(Plotter, Settings.DedupeTolerance);
+    if(Settings.Dedupe) Plotter = &Dedupe;
+
+    const char* Data;
+    size_t      Length, Offset;
+
+    RESULT Result;
+    if(Incremental && Reader.GetData(&Data, &Length, &Offset)){
+        Incremental->Options = Settings.Options;
+        Result.Success       = Incremental->Convert(Data, Length, Plotter);
+        Result.Diagnostics   = Incremental->Diagnostics;
+        Result.Statistics    = Incremental->Statistics;
+
+        if(Incremental->ResumedAt){
+            char Buffer[0x40];
+            sprintf(Buffer, "Resumed after line %d\n", Incremental->ResumedAt);
+            Log += Buffer;
+        }
+    }else{
+        Convert(&Reader, Plotter, Settings, Pool, Result, Log);
+    }
+    CheckInput(Reader, Result);
+
+    // Failures to write the outputs are reported apart from the conversion
+    bool Written = true;
+
+    // Completes the reordering and the panel if the input did not end
+    if(Settings.Reorder || Settings.Panel){
+        if(Settings.Reorder) Reorder.Finish();
+        if(Settings.Panel  ) Panel  .Finish();
+        if(!Plotter->Flush()) Written = false;
+    }
+
+    if(Compressed && !Gzip.Close()) Written = false;
+
+    long long BytesOut = Sink.Length;
 
-            default:
-                Line[Index] = 0;
-                break;
+    if(Settings.Split){
+        if(!Split.Close()){
+            Log += "Cannot write all the files of \"" + OutputFile + "\"\n";
+            Written = false;
         }
+        char Buffer[0x40];
+        sprintf(Buffer, "Wrote %d files, one per tool\n", (int)Split.Files().size());
+        Log     += Buffer;
+        BytesOut = Split.Length;
     }
 
-    int X = pX, Y = pY;
-    for(int n = 0; n < Count; n++){
-        X += dX;
-        Y += dY;
-        if(pX != X) fprintf(Output, "X%d", X);
-        if(pY != Y) fprintf(Output, "Y%d", Y);
-        fprintf(Output, "D03*\n");
-        pX = X;
-        pY = Y;
+    // Clean-up
+    Reader.Close();
+    if(Output && !CloseOutput(Output)) Written = false;
+    if(!Written && !Settings.Split) Log += "Cannot write \"" + OutputFile + "\"\n";
+
+    // The other formats are only complete once closed
+    bool SvgWritten = !Settings.Svg || (Svg.Close() && SvgFile.Close());
+    bool DxfWritten = !Settings.Dxf || (Dxf.Close() && DxfFile.Close());
+    bool CsvWritten = !Settings.Csv || (Csv.Close() && CsvFile.Close());
+    if(!SvgWritten) Log += "Cannot write \"" + SvgFile.Name + "\"\n";
+    if(!DxfWritten) Log += "Cannot write \"" + DxfFile.Name + "\"\n";
+    if(!CsvWritten) Log += "Cannot write \"" + CsvFile.Name + "\"\n";
+    if(!SvgWritten || !DxfWritten || !CsvWritten) Written = false;
+
+    if(Settings.Preview && Result.Success){
+        std::string PreviewFile = SideFile(OutputFile, Settings, Settings.Png ? ".png" : ".pgm");
+        if(!WritePreview(Preview, PreviewFile, Settings, Pool, Log)) Written = false;
     }
+
+    std::chrono::duration<double> Time = std::chrono::steady_clock::now() - Start;
+
+    if(Settings.Dedupe  ) ReportDuplicates(Dedupe,   Log);
+    if(Settings.Simplify) ReportSimplified(Simplify, Log);
+    if(Settings.Reorder ) ReportReordered (Reorder,  Log);
+
+    if(Settings.Statistics){
+        if(Settings.Json){
+            ReportJson(InputFile, Result, Time.count(), Result.BytesIn, BytesOut, Json);
+        }else{
+            ReportStatistics(Result, Time.count(), Result.BytesIn, BytesOut, Log);
+        }
+    }
+    return Report(Result.Diagnostics, Result.Success, Written, Log);
 }
 //------------------------------------------------------------------------------
 
-int WhiteSpace(int Index){
-    while(Line[Index] == ' ') Index++;
-    return Index;
+// Converts all the files concurrently and returns the worst exit code
+static int ConvertBatch(
+    const std::vector<std::string>& Files,
+    const SETTINGS&                 Settings,
+    int                             Threads,
+    FILE*                           Console
+){
+    auto Start = std::chrono::steady_clock::now();
+
+    THREAD_POOL Pool(Threads);
+    std::mutex  Mutex;
+
+    int Status = 0;
+    int Failed = 0;
+
+    for(size_t n = 0; n < Files.size(); n++){
+        Pool.Add([&, n]{
+            std::string Log, Json;
+            int Result = ConvertFile(Files[n], Settings, 0, Log, Json);
+
+            std::lock_guard<std::mutex> Lock(Mutex);
+            fprintf(Console, "%s:\n%s\n", Files[n].c_str(), Log.c_str());
+            fputs(Json.c_str(), stdout);
+            if(Result) Failed++;
+            if(Status < Result) Status = Result;
+        });
+    }
+    Pool.Wait();
+
+    std::chrono::duration<double> Time = std::chrono::steady_clock::now() - Start;
+
+    fprintf(Console,
+        "Converted %d of %d files in %.3f s using %d threads\n",
+        (int)Files.size() - Failed, (int)Files.size(),
+        Time.count(), Pool.Size()
+    );
+    if(Failed) fprintf(Console, "%d files failed\n", Failed);
+
+    return Status;
 }
 //------------------------------------------------------------------------------
 
-void GetHolesize(int Index){
-    int CharCount;
+// The number of split output files that each conversion may keep open, so
+// that all the threads together stay well within the process limit
+static int GetMaxOpen(int Threads){
+    if(Threads <= 0) Threads = std::thread::hardware_concurrency();
+    if(Threads <= 0) Threads = 1;
+
+    long Limit = 512;
+    #ifdef _WIN32
+        Limit = _getmaxstdio();
+    #else
+        struct rlimit Resource;
+        if(!getrlimit(RLIMIT_NOFILE, &Resource) && Resource.rlim_cur != RLIM_INFINITY){
+            Limit = Resource.rlim_cur;
+        }
+    #endif
 
-    Index = WhiteSpace(Index);
+    long MaxOpen = (Limit / 2) / Threads;
+    if(MaxOpen > 64) MaxOpen = 64;
+    if(MaxOpen <  1) MaxOpen =  1;
+    return MaxOpen;
+}
+//------------------------------------------------------------------------------
 
-    int Tool = GetTool(&CharCount, Index);
-    Index += CharCount;
+// Converts all the files concurrently, then writes them as one Gerber file
+// with a combined aperture table.  Returns the worst exit code.
+static int MergeFiles(
+    const std::vector<std::string>& Files,
+    const SETTINGS&                 Settings,
+    int                             Threads,
+    FILE*                           Console
+){
+    auto Start = std::chrono::steady_clock::now();
+
+    std::vector<RECORDER>    Recordings(Files.size());
+    std::vector<RESULT>      Results   (Files.size());
+    std::vector<std::string> Logs      (Files.size());
+    std::vector<int>         Status    (Files.size(), 0);
+
+    THREAD_POOL Pool(Threads);
+
+    for(size_t n = 0; n < Files.size(); n++){
+        Pool.Add([&, n]{
+            READER Reader;
+            if(!OpenInput(Files[n], Reader, Logs[n])){
+                Status[n] = 1;
+                return;
+            }
+            Convert(&Reader, &Recordings[n], Settings, 0, Results[n], Logs[n]);
+            CheckInput(Reader, Results[n]);
+            Status[n] = Report(Results[n].Diagnostics, Results[n].Success, true, Logs[n]);
+        });
+    }
+    Pool.Wait();
+
+    int    Result = 0;
+    RESULT Merged;
+    Merged.Success = true;
+
+    MERGE Merge;
+    for(size_t n = 0; n < Files.size(); n++){
+        fprintf(Console, "%s:\n%s\n", Files[n].c_str(), Logs[n].c_str());
+        if(Result < Status[n]) Result = Status[n];
+        if(Status[n] == 1) continue;
+
+        // The phases of the inputs add up, as they ran on the same threads
+        const STATISTICS& Statistics = Results[n].Statistics;
+        Merged.Statistics.Add(Statistics);
+        Merged.Statistics.Read .Wall += Statistics.Read .Wall;
+        Merged.Statistics.Read .CPU  += Statistics.Read .CPU;
+        Merged.Statistics.Parse.Wall += Statistics.Parse.Wall;
+        Merged.Statistics.Parse.CPU  += Statistics.Parse.CPU;
+        Merged.Statistics.Emit .Wall += Statistics.Emit .Wall;
+        Merged.Statistics.Emit .CPU  += Statistics.Emit .CPU;
+
+        Merge.Add(&Recordings[n]);
+    }
+
+    const std::string& OutputFile = Settings.OutputFile;
+    bool Compressed = Settings.Gzip || StripGzip(OutputFile) < OutputFile.length();
 
-    if(MaxTool < Tool) MaxTool = Tool;
-    // printf("Tool = %d\n", Tool);
+    std::string Log, Json;
+    FILE* Output = OpenOutput(OutputFile, Compressed, Log);
+    if(!Output){
+        fprintf(Console, "%s", Log.c_str());
+        return 2;
+    }
 
-    while(Line[Index] && (Line[Index] < '0' || Line[Index] > '9')) Index++;
-    int SizeStart = Index;
-    while((Line[Index] && Line[Index] >= '0' && Line[Index] <= '9') || Line[Index] == '.') Index++;
-    int SizeStop = Index;
+    FILE_SINK Sink(Output);
+    GZIP_SINK Gzip(&Sink);
+
+    GERBER_WRITER Gerber;
+    if(Compressed) Gerber.Open(&Gzip);
+    else           Gerber.Open(&Sink);
+
+    PLOTTER* Plotter = &Gerber;
+    PANEL    Panel(Plotter, Settings.Columns, Settings.Rows,
+                   Settings.PitchX, Settings.PitchY, Settings.Rotation);
+    if(Settings.Panel) Plotter = &Panel;
+    REORDER  Reorder(Plotter);
+    if(Settings.Reorder) Plotter = &Reorder;
+    SIMPLIFY Simplify(Plotter, Settings.SimplifyTolerance);
+    if(Settings.Simplify) Plotter = &Simplify;
+    DEDUPE   Dedupe(Plotter, Settings.DedupeTolerance);
+    if(Settings.Dedupe) Plotter = &Dedupe;
+
+    STOPWATCH Watch;
+    Merge.Write(Plotter);
+    if(!Plotter->Flush()) Merged.Success = false;
+    if(Compressed && !Gzip.Close()) Merged.Success = false;
+    if(!CloseOutput(Output))        Merged.Success = false;
+    Watch.Split(Merged.Statistics.Emit);
+
+    std::chrono::duration<double> Time = std::chrono::steady_clock::now() - Start;
+
+    if(!Merged.Success){
+        Log += "Cannot write \"" + OutputFile + "\"\n";
+        if(Result < 2) Result = 2;
+    }
+    char Buffer[0x80];
+    sprintf(Buffer, "Merged %d files into %d apertures in %.3f s\n",
+        (int)Merge.Count(), (int)Merge.Apertures.size(), Time.count()
+    );
+    Log += Buffer;
 
-    // printf("Size = '");
-    // for(int n = SizeStart; n <= SizeStop; n++) printf("%c", Line[n]);
-    // printf("'\n");
+    if(Settings.Dedupe  ) ReportDuplicates(Dedupe,   Log);
+    if(Settings.Simplify) ReportSimplified(Simplify, Log);
+    if(Settings.Reorder ) ReportReordered (Reorder,  Log);
 
-    if(SizeStart == SizeStop) return;
+    if(Settings.Statistics){
+        long long BytesIn = 0;
+        for(size_t n = 0; n < Files.size(); n++) BytesIn += Results[n].BytesIn;
 
-    while(Line[Index]){
-        if(Keyword(&Index, "PLATED") || Keyword(&Index, "NON_PLATED")) break;
-        Index++;
+        if(Settings.Json){
+            ReportJson(OutputFile, Merged, Time.count(), BytesIn, Sink.Length, Json);
+        }else{
+            ReportStatistics(Merged, Time.count(), BytesIn, Sink.Length, Log);
+        }
     }
+    fprintf(Console, "%s", Log.c_str());
+    fputs(Json.c_str(), stdout);
+    return Result;
+}
+//------------------------------------------------------------------------------
 
-    Index = WhiteSpace(Index);
+#ifdef __linux__
+// A watched drill file, with its converter kept between conversions
+struct WATCHED{
+    INCREMENTAL Incremental;
 
-    bool isMetric = false;
-    if(Keyword(&Index, "MM")){
-        isMetric = true;
+    bool     Converted;
+    uint64_t Checksum; // Of the content last converted
 
-    }else if(Keyword(&Index, "MILS")){
-        isMetric = false;
+    bool Pending;
+    std::chrono::steady_clock::time_point Due;
 
-    }else{
-        return;
+    WATCHED(){
+        Converted = false;
+        Checksum  = 0;
+        Pending   = false;
     }
+};
+//------------------------------------------------------------------------------
 
-    if(!RecognisedFormat){
-        if(isMetric){
-            printf("\nWarning: Hole size specified in header, but the coordinate\n"
-                          "         format is not yet specified.  Assuming metric 5.5\n\n");
-            IntDigits      = 5;
-            FractionDigits = 5;
-            fprintf(Output,
-                "%%FSLAX%d%dY%d%d*MOMM*%%\n",
-                IntDigits, FractionDigits,
-                IntDigits, FractionDigits
-            );
-        }else{
-            printf("\nWarning: Hole size specified in header, but the coordinate\n"
-                          "         format is not yet specified.  Assuming inch 2.4\n\n");
-            IntDigits      = 2;
-            FractionDigits = 4;
-            fprintf(Output,
-                "%%FSLAX%d%dY%d%d*MOIN*%%\n",
-                IntDigits, FractionDigits,
-                IntDigits, FractionDigits
-            );
-        }
-        RecognisedFormat = true;
+// Writes are coalesced until the file has been quiet for this long
+static const int WatchDelay = 250; // ms
+//------------------------------------------------------------------------------
+
+// Reconverts the file if its content changed since the last conversion
+static void Reconvert(
+    const std::string& Filename,
+    WATCHED&           File,
+    const SETTINGS&    Settings,
+    THREAD_POOL*       Pool,
+    FILE*              Console
+){
+    READER Reader;
+    if(!Reader.Open(Filename.c_str())) return; // Removed in the meantime
+
+    const char* Data;
+    size_t      Length, Offset;
+    uint64_t    Checksum = 0;
+
+    // Compressed files and pipes are converted whenever they are written
+    if(Reader.GetData(&Data, &Length, &Offset)){
+        Checksum = Hash(Data, Length);
+        if(File.Converted && File.Checksum == Checksum) return;
     }
+    Reader.Close();
+
+    std::string Log, Json;
+    ConvertFile(Filename, Settings, Pool, Log, Json, &File.Incremental);
+
+    File.Converted = true;
+    File.Checksum  = Checksum;
 
-    fprintf(Output, "%%ADD%02dC,", Tool+10);
-    for(int n = SizeStart; n <= SizeStop; n++) fprintf(Output, "%c", Line[n]);
-    fprintf(Output, "*%%\n");
+    time_t Now = time(0);
+    char   Time[0x20];
+    strftime(Time, sizeof(Time), "%H:%M:%S", localtime(&Now));
+    fprintf(Console, "[%s] %s:\n%s\n", Time, Filename.c_str(), Log.c_str());
+    fputs(Json.c_str(), stdout);
+    fflush(Console);
+    fflush(stdout);
 }
 //------------------------------------------------------------------------------
 
-void ParseComment(){
-    int Index = 1;
+// Converts the drill files in the directories (or the given files), and then
+// waits for them to be written and reconverts them.  Runs until the process
+// is stopped.
+static int WatchFiles(
+    const std::vector<std::string>& Arguments,
+    const SETTINGS&                 Settings,
+    int                             Threads
+){
+    FILE* Console = Settings.Json ? stderr : stdout;
+
+    int Handle = inotify_init1(IN_CLOEXEC);
+    if(Handle < 0){
+        fprintf(Console, "Cannot start watching: %s\n", strerror(errno));
+        return 1;
+    }
+
+    // The watched directories, and the names watched in each (all drill
+    // files when empty)
+    struct DIRECTORY{
+        std::string           Path;
+        std::set<std::string> Names;
+    };
+    std::map<int, DIRECTORY>        Directories;
+    std::map<std::string, WATCHED> Files;
+
+    const uint32_t Events = IN_CLOSE_WRITE | IN_MODIFY  | IN_MOVED_TO |
+                            IN_DELETE      | IN_MOVED_FROM;
+
+    for(size_t n = 0; n < Arguments.size(); n++){
+        std::string Path = Arguments[n];
+        std::string Name;
+
+        if(!IsDirectory(Path)){
+            size_t Slash = Path.find_last_of('/');
+            if(Slash == std::string::npos){
+                Name = Path;
+                Path = ".";
+            }else{
+                Name = Path.substr(Slash+1);
+                Path.resize(Slash+1);
+            }
+        }
+        if(Path.back() != '/') Path += '/';
+
+        int Watch = inotify_add_watch(Handle, Path.c_str(), Events);
+        if(Watch < 0){
+            fprintf(Console, "Cannot watch \"%s\": %s\n", Path.c_str(), strerror(errno));
+            return 1;
+        }
+        DIRECTORY& Directory = Directories[Watch];
+
+        // A whole directory includes any file of it, given before or after
+        bool All = Name.empty() || (!Directory.Path.empty() && Directory.Names.empty());
+        Directory.Path = Path;
+        if(All) Directory.Names.clear();
+        else    Directory.Names.insert(Name);
+
+        std::vector<std::string> Found;
+        if(Name.empty()) AddDirectory(Path, 0, Found);
+        else if(!access((Path + Name).c_str(), R_OK)) Found.push_back(Path + Name);
+        for(auto& File: Found) Files[File].Pending = true;
+    }
+
+    THREAD_POOL Pool(Threads);
+
+    fprintf(Console, "Watching for changes; press Ctrl+C to stop\n");
+    fflush(Console);
+
+    // inotify_event is followed by the name, so the buffer must be aligned
+    alignas(struct inotify_event) char Buffer[0x10000];
+
+    while(true){
+        auto Now = std::chrono::steady_clock::now();
+
+        int Timeout = -1;
+        for(auto& Entry: Files){
+            WATCHED& File = Entry.second;
+            if(!File.Pending) continue;
+
+            if(File.Due <= Now){
+                File.Pending = false;
+                Reconvert(Entry.first, File, Settings, &Pool, Console);
+                Now = std::chrono::steady_clock::now();
+                continue;
+            }
+            int Wait = std::chrono::duration_cast<std::chrono::milliseconds>(File.Due - Now).count() + 1;
+            if(Timeout < 0 || Timeout > Wait) Timeout = Wait;
+        }
+
+        pollfd Poll;
+        Poll.fd      = Handle;
+        Poll.events  = POLLIN;
+        Poll.revents = 0;
+
+        int Result = poll(&Poll, 1, Timeout);
+        if(Result < 0 && errno != EINTR) break;
+        if(Result <= 0) continue;
+
+        ssize_t Length = read(Handle, Buffer, sizeof(Buffer));
+        if(Length <= 0) continue;
+
+        Now = std::chrono::steady_clock::now();
+
+        for(char* p = Buffer; p < Buffer + Length;){
+            inotify_event* Event = (inotify_event*)p;
+            p += sizeof(inotify_event) + Event->len;
 
-    Index = WhiteSpace(Index);
-    if(Keyword(&Index, "FILE_FORMAT")){
-        if(!strncmp(Line+Index, "=2:5", 15)) Format_25 = true;
+            if(!Event->len || (Event->mask & IN_ISDIR)) continue;
 
-    }else if(Keyword(&Index, "Holesize")){
-        GetHolesize(Index);
+            auto Found = Directories.find(Event->wd);
+            if(Found == Directories.end()) continue;
+
+            const DIRECTORY& Directory = Found->second;
+            std::string      Name      = Event->name;
+
+            if(Directory.Names.empty() ? !IsDrillFile(Name) : !Directory.Names.count(Name)){
+                continue;
+            }
+            std::string Filename = Directory.Path + Name;
+
+            if(Event->mask & (IN_DELETE | IN_MOVED_FROM)){
+                Files.erase(Filename);
+                continue;
+            }
+            WATCHED& File = Files[Filename];
+            File.Pending  = true;
+            File.Due      = Now + std::chrono::milliseconds(WatchDelay);
+        }
     }
+    fprintf(Console, "Stopped watching: %s\n", strerror(errno));
+    close(Handle);
+    return 1;
 }
 //------------------------------------------------------------------------------
+#endif
 
-void ConvertLine(){
-    static bool Header = true;
+#ifndef _WIN32
+static SERVER* ActiveServer = 0;
 
-    int CharCount;
+static void StopServer(int){
+    if(ActiveServer) ActiveServer->Stop();
+}
+//------------------------------------------------------------------------------
 
-    if(Header){
-        switch(Line[0]){
-            case 'I':
-                if(Line[1] == 'N' && Line[2] == 'C' && Line[3] == 'H'){
-                    IntDigits        = 2;
-                    FractionDigits   = 4;
-                    LeadingZeros     = true;
-                    RecognisedFormat = true;
+// Serves conversion requests until interrupted, or until the end of stdin,
+// and then reports the counters
+static int Serve(const SETTINGS& Settings, int Threads){
+    SERVER Server(Threads, Settings.Limits);
 
-                    if(Format_25) FractionDigits = 5;
+    if(Settings.Serve == "-"){
+        Server.Serve(fileno(stdin), fileno(stdout));
+        fprintf(stderr, "%s", Server.GetCounters().c_str());
+        return 0;
+    }
 
-                    if     (Line[5] == 'T') LeadingZeros = false;
-                    if     (Line[5] == '0') GetFormat(5);
-                    else if(Line[8] == '0') GetFormat(8);
+    if(!Server.Listen(Settings.Serve.c_str())){
+        printf("Cannot listen on \"%s\": %s\n", Settings.Serve.c_str(), strerror(errno));
+        return 1;
+    }
+    ActiveServer = &Server;
+    signal(SIGINT,  StopServer);
+    signal(SIGTERM, StopServer);
 
-                    fprintf(Output,
-                        "%%FSLAX%d%dY%d%d*MOIN*%%\n",
-                        IntDigits, FractionDigits,
-                        IntDigits, FractionDigits
-                    );
-                }
-                break;
-
-            case 'M':
-                if(Line[1] == 'E' && Line[2] == 'T' && Line[3] == 'R'){
-                    IntDigits        = 3;
-                    FractionDigits   = 3;
-                    LeadingZeros     = true;
-                    RecognisedFormat = true;
-
-                    if     (Line[ 7] == 'T') LeadingZeros = false;
-                    if     (Line[ 7] == '0') GetFormat( 7);
-                    else if(Line[10] == '0') GetFormat(10);
-
-                    fprintf(Output,
-                        "%%FSLAX%d%dY%d%d*MOMM*%%\n",
-                        IntDigits, FractionDigits,
-                        IntDigits, FractionDigits
-                    );
-                }
-                break;
+    printf("Listening on \"%s\"; press Ctrl+C to stop\n", Settings.Serve.c_str());
+    fflush(stdout);
 
-            case 'T': // Define drill width
-                Tool = GetTool(&CharCount);
-                fprintf(Output, "%%ADD%02dC,%s*%%\n", Tool+10, GetToolDiameter(Line+CharCount));
-                if(MaxTool < Tool) MaxTool = Tool;
-                break;
+    Server.Run();
+    ActiveServer = 0;
 
-            case '%':
-                Tool   = 1;
-                Header = false;
-                fprintf(Output, "%%LPD*%%\nG01*\n");
-                break;
+    printf("%s", Server.GetCounters().c_str());
+    return 0;
+}
+//------------------------------------------------------------------------------
+
+// Reads the whole input, without decompressing it
+static bool ReadInput(const std::string& InputFile, std::string& Data, std::string& Log){
+    FILE* Input = stdin;
+    if(InputFile != "-"){
+        Input = fopen(InputFile.c_str(), "rb");
+        if(!Input){
+            Log += "Cannot open \"" + InputFile + "\" for reading\n";
+            return false;
+        }
+    }
+    char   Buffer[0x10000];
+    size_t Count;
+    while((Count = fread(Buffer, 1, sizeof(Buffer), Input))) Data.append(Buffer, Count);
 
-            case ';':
-                ParseComment();
-                break;
+    bool Result = !ferror(Input);
+    if(Input != stdin) fclose(Input);
+    if(!Result) Log += "Cannot read \"" + InputFile + "\"\n";
+    return Result;
+}
+//------------------------------------------------------------------------------
+
+static uint32_t GetFlags(const SETTINGS& Settings){
+    uint32_t Flags = 0;
+    if(Settings.Options.StepRepeat) Flags |= PROTOCOL::Flag_StepRepeat;
+    if(Settings.Dedupe            ) Flags |= PROTOCOL::Flag_Dedupe;
+    if(Settings.Simplify          ) Flags |= PROTOCOL::Flag_Simplify;
+    if(Settings.Reorder           ) Flags |= PROTOCOL::Flag_Reorder;
+    return Flags;
+}
+//------------------------------------------------------------------------------
 
-            default:
-                break;
+// Converts every file through the server, to the same outputs as converting
+// locally, and returns the worst exit code
+static int ConvertRemote(
+    const std::vector<std::string>& Files,
+    const SETTINGS&                 Settings,
+    FILE*                           Console
+){
+    CLIENT Client;
+    if(!Client.Connect(Settings.Client.c_str())){
+        fprintf(Console, "Cannot connect to \"%s\": %s\n", Settings.Client.c_str(), strerror(errno));
+        return 1;
+    }
+
+    int Result = 0;
+    for(size_t n = 0; n < Files.size(); n++){
+        const std::string& InputFile = Files[n];
+
+        std::string Log;
+        std::string Data;
+        if(!ReadInput(InputFile, Data, Log)){
+            fprintf(Console, "%s", Log.c_str());
+            Result = std::max(Result, 1);
+            continue;
         }
-    }else{
-        switch(Line[0]){
-            case 'T':
-                Tool = GetTool(&CharCount);
-                if(Tool > 0 && Tool <= MaxTool) fprintf(Output, "D%02d*\n", Tool+10);
-                ToolSelected = true;
-                break;
-
-            case 'X':
-            case 'Y':
-            case 'I':
-            case 'J':
-            case 'A':
-                DoCoord(0);
-                break;
-
-            case 'R':
-                DoRepeat();
-                break;
-
-            case 'M':
-                if     (IsLine("M48")) Header = true;
-                else if(IsLine("M30")) fprintf(Output, "M02*\n");
-                else if(IsLine("M15")) Z_Axis = Z_Routing;
-                else if(IsLine("M16")) Z_Axis = Z_Retracted;
-                else if(IsLine("M17")) Z_Axis = Z_Retracted;
-                else if(IsLine("M00")){
-                    Tool++;
-                    if(Tool > 0 && Tool <= MaxTool) fprintf(Output, "D%02d*\n", Tool+10);
-                    ToolSelected = true;
-                }
-                break;
-
-            case 'G':
-                if(
-                    (Line[1] == '0' && Line[2] == '5') |
-                    (Line[1] == '8' && Line[2] == '1')
-                ){
-                    Z_Axis = Z_Retracted;
-                    Mode   = Mode_Drill;
-                    fprintf(Output, "G01*\n");
-
-                }else if(Line[1] == '0' && Line[2] == '0'){
-                    Mode = Mode_Route_Move;
-                    DoCoord(3);
-
-                }else if(Line[1] == '0' && Line[2] == '1'){
-                    Mode = Mode_Route_Linear;
-                    fprintf(Output, "G01*\n");
-                    DoCoord(3);
-
-                }else if(Line[1] == '0' && Line[2] == '2'){
-                    Mode = Mode_Route_CW;
-                    fprintf(Output, "G02*\nG75*\n");
-                    DoCoord(3);
-
-                }else if(Line[1] == '0' && Line[2] == '3'){
-                    Mode = Mode_Route_CCW;
-                    fprintf(Output, "G03*\nG75*\n");
-                    DoCoord(3);
-
-                }else if(Line[1] == '3' && Line[2] == '2'){
-                    Mode = Mode_Route_Canned_CW;
-                    fprintf(Output, "G02*\nG75*\n");
-                    DoCoord(3);
-
-                }else if(Line[1] == '3' && Line[2] == '3'){
-                    Mode = Mode_Route_Canned_CCW;
-                    fprintf(Output, "G03*\nG75*\n");
-                    DoCoord(3);
-
-                }else if(Line[1] == '9' && Line[2] == '0'){
-                }else if(Line[1] == '9' && Line[2] == '3'){
-                    printf("Warning: Zero-set command (G93) ignored\n");
 
+        PROTOCOL::RESPONSE Response;
+        if(!Client.Convert(Data.data(), Data.length(), GetFlags(Settings), Response)){
+            fprintf(Console, "Lost the connection to \"%s\"\n", Settings.Client.c_str());
+            return std::max(Result, 1);
+        }
+        Log += Response.Log;
+
+        int Code = 3;
+        if(Response.Status == PROTOCOL::Status_Success){
+            std::string OutputFile = Settings.OutputFile;
+            if(OutputFile.empty()){
+                if(InputFile == "-") OutputFile = "-";
+                else                 OutputFile = InputFile.substr(0, StripGzip(InputFile)) + ".grb";
+            }
+            FILE* Output = OpenOutput(OutputFile, false, Log);
+            Code = 2;
+            if(Output){
+                bool Written = fwrite(Response.Output.data(), 1, Response.Output.length(), Output) ==
+                               Response.Output.length();
+                if(CloseOutput(Output) && Written){
+                    Log += "Drill to Gerber conversion successful\n";
+                    Code = 0;
                 }else{
-                    printf(
-                        "Warning: Unsupported code: G%c%c\\n"
-                        "\n%s",
-                        Line[1], Line[2],
-                        BugReportString
-                    );
+                    Log += "Cannot write \"" + OutputFile + "\"\n";
                 }
-
-            default:
-                break;
+            }
         }
+        if(Files.size() > 1) fprintf(Console, "%s:\n%s\n", InputFile.c_str(), Log.c_str());
+        else                 fprintf(Console, "%s", Log.c_str());
+
+        Result = std::max(Result, Code);
+    }
+    return Result;
+}
+//------------------------------------------------------------------------------
+
+static int RunLoadTest(const std::string& InputFile, const SETTINGS& Settings, int Threads){
+    std::string Log;
+    std::string Data;
+    if(!ReadInput(InputFile, Data, Log)){
+        printf("%s", Log.c_str());
+        return 1;
+    }
+
+    int Connections = Settings.Connections;
+    if(Connections <= 0) Connections = Threads > 0 ? Threads : std::thread::hardware_concurrency();
+
+    std::string Report;
+    bool Result = LoadTest(
+        Settings.LoadTest.c_str(), Data.data(), Data.length(), GetFlags(Settings),
+        Connections, Settings.Requests, Report
+    );
+    printf("%s", Report.c_str());
+    if(!Result){
+        printf("Some connections to \"%s\" failed\n", Settings.LoadTest.c_str());
+        return 1;
     }
+    return 0;
 }
 //------------------------------------------------------------------------------
+#endif
 
 int main(int argc, char** argv){
     if(argc < 2){
@@ -672,6 +1491,95 @@ int main(int argc, char** argv){
             "along with this program.  If not, see <http://www.gnu.org/licenses/>\n"
             "\n"
             "Usage: Drill2Gerber input_file\n"
+            "       Drill2Gerber [options] input ...\n"
+            "       Drill2Gerber [options] - < input > output\n"
+            "\n"
+            "Options:\n"
+            "  -o file        Output file of a single input, or \"-\" for stdout.\n"
+            "                 The default is the input name with \".grb\" added,\n"
+            "                 or stdout when the input is \"-\" (stdin).\n"
+            "  -j threads     Number of threads (default: one per core).  Large\n"
+            "                 single files are also split over the threads.\n"
+            "  --step-repeat  Write repeat hole commands as step-and-repeat blocks\n"
+            "  --pipeline     Read, convert and write a single file on separate\n"
+            "                 threads, instead of splitting it\n"
+            "  --dedupe[=mm]  Remove repeated hits of the same tool, within the\n"
+            "                 given distance (default: exact repeats only)\n"
+            "  --simplify[=mm]\n"
+            "                 Merge straight runs of route segments, moving no\n"
+            "                 point by more than the given distance (default:\n"
+            "                 exactly collinear segments only)\n"
+            "  --reorder      Group the drill hits by tool, and order the hits of\n"
+            "                 every tool along a space-filling curve, to reduce\n"
+            "                 aperture changes and travel.  Routes keep their\n"
+            "                 order.\n"
+            "  --panel CxR    Step the board into a panel of C columns by R rows,\n"
+            "                 with one step-and-repeat block\n"
+            "  --pitch X[,Y]  Distance between the boards of the panel in mm\n"
+            "                 (default Y: the same as X)\n"
+            "  --rotate deg   Rotate the boards of the panel counter-clockwise\n"
+            "                 about their origin by 0, 90, 180 or 270 degrees\n"
+            "  --preview[=png|pgm]\n"
+            "                 Also draw the output into a bitmap, written to the\n"
+            "                 output name with \".png\" (or \".pgm\") instead of\n"
+            "                 \".grb\"\n"
+            "  --dpi n        Resolution of the preview (default 300)\n"
+            "  --svg          Also write the output as an SVG drawing, to the\n"
+            "                 output name with \".svg\" instead of \".grb\"\n"
+            "  --dxf          Also write the output as a DXF drawing, with one\n"
+            "                 layer per tool, to \".dxf\"\n"
+            "  --csv          Also list the drill hits as tool, diameter, x and\n"
+            "                 y, to \".csv\".  All the formats are written from\n"
+            "                 a single conversion.\n"
+            "  --watch        Convert the inputs (files or directories), then keep\n"
+            "                 reconverting them whenever they change.  Files\n"
+            "                 that are only appended to are converted from where\n"
+            "                 the previous conversion stopped.\n"
+            "  --cache dir    Keep converted models in the directory, and reuse\n"
+            "                 them for inputs that have not changed\n"
+            "  --stats[=json] Report the time of every phase, the input and\n"
+            "                 output sizes and counters per tool, as text or as\n"
+            "                 one JSON object per file on stdout, with the other\n"
+            "                 messages on stderr\n"
+            "  --merge        Merge all the inputs (such as plated, non-plated and\n"
+            "                 routed holes) into one Gerber file, given by -o,\n"
+            "                 with one aperture per diameter\n"
+            "  --split        Write every tool to its own file,\n"
+            "                 \"<output>.T<tool>.grb\", in one pass.  A .grb or\n"
+            "                 .gz extension of the output is left out.\n"
+            "  --gzip         Compress the output.  Compressed (.gz) inputs are\n"
+            "                 always converted to compressed outputs.\n"
+            "\n"
+            "Server options (not available on Windows):\n"
+            "  --serve socket Convert requests sent to the Unix domain socket,\n"
+            "                 or framed on stdin and stdout for \"-\", on the\n"
+            "                 threads given by -j\n"
+            "  --max-input MB Largest input accepted by the server, before and\n"
+            "                 after decompression (default 64)\n"
+            "  --max-output MB\n"
+            "                 Largest output returned by the server (default:\n"
+            "                 four times the input limit)\n"
+            "  --time-limit s Longest time per request, including the time\n"
+            "                 queued, and longest time a client may be idle\n"
+            "                 (default 30)\n"
+            "  --queue n      Requests queued or converted at a time, beyond\n"
+            "                 which clients are made to wait (default: twice\n"
+            "                 the threads)\n"
+            "  --client socket\n"
+            "                 Convert the inputs through the server at the\n"
+            "                 socket.  Only --step-repeat, exact --dedupe,\n"
+            "                 exact --simplify and --reorder are passed on.\n"
+            "  --load-test socket\n"
+            "                 Send the input to the server repeatedly, and\n"
+            "                 report the throughput and latency\n"
+            "  --requests n   Requests of the load test (default 1000)\n"
+            "  --connections n\n"
+            "                 Concurrent connections of the load test\n"
+            "                 (default: one per thread)\n"
+            "\n"
+            "Each input can be a file, a directory, a wildcard pattern or\n"
+            "@list_file (with one input per line).  More than one file is\n"
+            "converted in parallel, by default using one thread per core.\n"
             "\n"
             "Tested on drill files from:\n"
             "- Altium Designer\n"
@@ -688,56 +1596,306 @@ int main(int argc, char** argv){
         return 0;
     }
 
-    Input = fopen(argv[1], "r");
-    if(!Input){
-        printf("Cannot open \"%s\" for reading\n", argv[1]);
-        Pause();
-        return 1;
+    int  Threads = 0;
+    bool Batch   = false;
+
+    SETTINGS Settings;
+
+    std::vector<std::string> Arguments;
+    std::vector<std::string> Files;
+
+    for(int n = 1; n < argc; n++){
+        if(!strcmp(argv[n], "-j") && n+1 < argc){
+            Threads = atoi(argv[++n]);
+
+        }else if(!strcmp(argv[n], "-o") && n+1 < argc){
+            Settings.OutputFile = argv[++n];
+
+        }else if(!strcmp(argv[n], "--step-repeat")){
+            Settings.Options.StepRepeat = true;
+
+        }else if(!strcmp(argv[n], "--cache") && n+1 < argc){
+            Settings.CacheDirectory = argv[++n];
+
+        }else if(!strcmp(argv[n], "--stats")){
+            Settings.Statistics = true;
+
+        }else if(!strcmp(argv[n], "--stats=json")){
+            Settings.Statistics = true;
+            Settings.Json       = true;
+
+        }else if(!strcmp(argv[n], "--panel") && n+1 < argc){
+            Settings.Panel = true;
+            if(sscanf(argv[++n], "%dx%d", &Settings.Columns, &Settings.Rows) != 2 ||
+               Settings.Columns < 1 || Settings.Rows < 1){
+                printf("Invalid panel size \"%s\"; expected columns x rows, such as 3x2\n", argv[n]);
+                return 1;
+            }
+
+        }else if(!strcmp(argv[n], "--pitch") && n+1 < argc){
+            int Count = sscanf(argv[++n], "%lf,%lf", &Settings.PitchX, &Settings.PitchY);
+            if(Count < 1){
+                printf("Invalid pitch \"%s\"\n", argv[n]);
+                return 1;
+            }
+            if(Count == 1) Settings.PitchY = Settings.PitchX;
+
+        }else if(!strcmp(argv[n], "--rotate") && n+1 < argc){
+            Settings.Panel    = true;
+            Settings.Rotation = atoi(argv[++n]);
+            if(Settings.Rotation % 90){
+                printf("The rotation must be a multiple of 90 degrees\n");
+                return 1;
+            }
+
+        }else if(!strcmp(argv[n], "--serve") && n+1 < argc){
+            Settings.Serve = argv[++n];
+
+        }else if(!strcmp(argv[n], "--client") && n+1 < argc){
+            Settings.Client = argv[++n];
+
+        }else if(!strcmp(argv[n], "--load-test") && n+1 < argc){
+            Settings.LoadTest = argv[++n];
+
+        }else if(!strcmp(argv[n], "--requests") && n+1 < argc){
+            Settings.Requests = atoll(argv[++n]);
+
+        }else if(!strcmp(argv[n], "--connections") && n+1 < argc){
+            Settings.Connections = atoi(argv[++n]);
+
+        }else if(!strcmp(argv[n], "--max-input") && n+1 < argc){
+            Settings.Limits.MaxInput = (size_t)(atof(argv[++n]) * (1 << 20));
+
+        }else if(!strcmp(argv[n], "--max-output") && n+1 < argc){
+            Settings.Limits.MaxOutput = (size_t)(atof(argv[++n]) * (1 << 20));
+
+        }else if(!strcmp(argv[n], "--time-limit") && n+1 < argc){
+            Settings.Limits.TimeLimit = (int)(atof(argv[++n]) * 1000);
+            if(Settings.Limits.TimeLimit <= 0){
+                printf("The time limit must be positive\n");
+                return 1;
+            }
+
+        }else if(!strcmp(argv[n], "--queue") && n+1 < argc){
+            Settings.Limits.MaxQueued = atoi(argv[++n]);
+
+        }else if(!strcmp(argv[n], "--preview") || !strcmp(argv[n], "--preview=png")){
+            Settings.Preview = true;
+            Settings.Png     = true;
+
+        }else if(!strcmp(argv[n], "--preview=pgm")){
+            Settings.Preview = true;
+            Settings.Png     = false;
+
+        }else if(!strcmp(argv[n], "--dpi") && n+1 < argc){
+            Settings.Dpi = atof(argv[++n]);
+            if(!(Settings.Dpi > 0)){
+                printf("The resolution must be positive\n");
+                return 1;
+            }
+
+        }else if(!strcmp(argv[n], "--svg")){
+            Settings.Svg = true;
+
+        }else if(!strcmp(argv[n], "--dxf")){
+            Settings.Dxf = true;
+
+        }else if(!strcmp(argv[n], "--csv")){
+            Settings.Csv = true;
+
+        }else if(!strcmp(argv[n], "--watch")){
+            Settings.Watch = true;
+
+        }else if(!strcmp(argv[n], "--reorder")){
+            Settings.Reorder = true;
+
+        }else if(!strcmp(argv[n], "--split")){
+            Settings.Split = true;
+
+        }else if(!strcmp(argv[n], "--merge")){
+            Settings.Merge = true;
+
+        }else if(!strcmp(argv[n], "--gzip")){
+            Settings.Gzip = true;
+
+        }else if(!strcmp(argv[n], "--pipeline")){
+            Settings.Pipeline = true;
+
+        }else if(!strncmp(argv[n], "--dedupe", 8) && (!argv[n][8] || argv[n][8] == '=')){
+            Settings.Dedupe = true;
+            if(argv[n][8]) Settings.DedupeTolerance = atof(argv[n]+9);
+
+        }else if(!strncmp(argv[n], "--simplify", 10) && (!argv[n][10] || argv[n][10] == '=')){
+            Settings.Simplify = true;
+            if(argv[n][10]) Settings.SimplifyTolerance = atof(argv[n]+11);
+
+        }else{
+            Arguments.push_back(argv[n]);
+        }
     }
 
-    int j;
-    for(j = 0; argv[1][j]; j++);
-    char* OutputFile = new char[j+5];
-    for(j = 0; argv[1][j]; j++) OutputFile[j] = argv[1][j];
-    OutputFile[j++] = '.';
-    OutputFile[j++] = 'g';
-    OutputFile[j++] = 'r';
-    OutputFile[j++] = 'b';
-    OutputFile[j  ] =  0 ;
+    bool Remote = !Settings.Client.empty() || !Settings.LoadTest.empty();
 
-    Output = fopen(OutputFile, "w");
-    if(!Output){
-        printf("Cannot open \"%s\" for writing\n", OutputFile);
-        fclose(Input);
-        delete[] OutputFile;
-        Pause();
-        return 2;
+    #ifdef _WIN32
+        if(!Settings.Serve.empty() || Remote){
+            printf("--serve, --client and --load-test are not supported on Windows\n");
+            return 1;
+        }
+    #else
+        if(!Settings.Serve.empty()) return Serve(Settings, Threads);
+    #endif
+
+    if(Remote){
+        if(Settings.Watch || Settings.Merge || Settings.Split || Settings.Panel ||
+           Settings.Gzip  || Settings.Preview || !Settings.CacheDirectory.empty() ||
+           Settings.Svg   || Settings.Dxf     || Settings.Csv){
+            printf("--client and --load-test cannot be combined with --watch, --merge,\n"
+                   "--split, --panel, --gzip, --preview, --svg, --dxf, --csv or --cache\n");
+            return 1;
+        }
+        if(Settings.DedupeTolerance != 0 || Settings.SimplifyTolerance != 0){
+            printf("The server only removes exact duplicates and collinear segments\n");
+            return 1;
+        }
     }
 
-    Line = new char[0x1000];
+    if(Settings.Watch){
+        if(Arguments.empty()){
+            printf("No files or directories to watch\n");
+            return 1;
+        }
+        if(!Settings.OutputFile.empty() || Settings.Merge){
+            printf("--watch cannot be combined with -o or --merge\n");
+            return 1;
+        }
+        #ifdef __linux__
+            if(Settings.Split) Settings.MaxOpen = GetMaxOpen(1);
+            return WatchFiles(Arguments, Settings, Threads);
+        #else
+            printf("--watch is only supported on Linux\n");
+            return 1;
+        #endif
+    }
 
-    while(ReadLine()) ConvertLine();
+    for(size_t n = 0; n < Arguments.size(); n++){
+        const char* Argument = Arguments[n].c_str();
+        if(Arguments[n] == "-"){
+            Files.push_back("-");
+            continue;
+        }
+        if(!AddInput(Argument, Files)) return 1;
+        if(strcmp(Files.back().c_str(), Argument)) Batch = true;
+    }
+    if(Files.empty()){
+        printf("No input files specified\n");
+        return 1;
+    }
+    if(Files.size() > 1) Batch = true;
 
-    // Clean-up
-    fclose(Input);
-    fclose(Output);
+    #ifndef _WIN32
+        if(!Settings.LoadTest.empty()){
+            if(Files.size() > 1){
+                printf("--load-test takes a single input file\n");
+                return 1;
+            }
+            return RunLoadTest(Files[0], Settings, Threads);
+        }
+    #endif
+
+    // Keep the messages out of the output
+    bool  ToStdout = (Settings.OutputFile == "-") ||
+                     (Settings.OutputFile.empty() && Files[0] == "-" && !Settings.Merge);
+    FILE* Console  = ToStdout ? stderr : stdout;
+
+    // The other messages go to stderr, to keep the JSON objects apart
+    if(Settings.Json){
+        if(ToStdout){
+            printf("--stats=json writes to stdout, so it needs an output file name\n");
+            return 1;
+        }
+        Console = stderr;
+    }
 
-    delete[] Line;
-    delete[] OutputFile;
+    #ifndef _WIN32
+        if(!Settings.Client.empty()){
+            if(Files.size() > 1 && !Settings.OutputFile.empty()){
+                printf("-o can only be used with a single input file\n");
+                return 1;
+            }
+            if(Files.size() > 1 && std::find(Files.begin(), Files.end(), "-") != Files.end()){
+                printf("- (stdin) can only be used as the only input\n");
+                return 1;
+            }
+            return ConvertRemote(Files, Settings, Console);
+        }
+    #endif
 
-    if(!RecognisedFormat){
-        printf("\nError: Unrecognised drill coordinate format\n\n");
-        Error = true;
+    if(Settings.Panel && Settings.PitchX == 0 && Settings.PitchY == 0 &&
+       Settings.Columns * Settings.Rows > 1){
+        printf("--panel requires the pitch between boards (--pitch)\n");
+        return 1;
     }
 
-    if(Error){
-        printf(BugReportString);
-        return 3;
+    if(Settings.Split){
+        if(Settings.Merge){
+            printf("--split cannot be combined with --merge\n");
+            return 1;
+        }
+        Settings.MaxOpen = GetMaxOpen(Batch ? Threads : 1);
+    }
 
-    }else{
-        printf("Drill to Gerber conversion successful\n");
+    bool Formats = Settings.Svg || Settings.Dxf || Settings.Csv;
+
+    if(Settings.Preview && ToStdout){
+        printf("--preview needs an output file name\n");
+        return 1;
+    }
+    if(Formats && ToStdout){
+        printf("--svg, --dxf and --csv need an output file name\n");
+        return 1;
     }
 
-    return 0;
+    if(Settings.Merge){
+        if(Settings.Preview){
+            printf("--preview cannot be combined with --merge\n");
+            return 1;
+        }
+        if(Formats){
+            printf("--svg, --dxf and --csv cannot be combined with --merge\n");
+            return 1;
+        }
+        if(Settings.OutputFile.empty()){
+            printf("--merge requires an output file (-o)\n");
+            return 1;
+        }
+        if(std::count(Files.begin(), Files.end(), "-") > 1){
+            printf("- (stdin) can only be used once\n");
+            return 1;
+        }
+        return MergeFiles(Files, Settings, Threads, Console);
+    }
+
+    if(Batch){
+        if(!Settings.OutputFile.empty()){
+            printf("-o can only be used with a single input file\n");
+            return 1;
+        }
+        if(std::find(Files.begin(), Files.end(), "-") != Files.end()){
+            printf("- (stdin) can only be used as the only input\n");
+            return 1;
+        }
+        return ConvertBatch(Files, Settings, Threads, Console);
+    }
+
+    THREAD_POOL Pool(Threads);
+
+    std::string Log, Json;
+    int Result = ConvertFile(Files[0], Settings, &Pool, Log, Json);
+    fprintf(Console, "%s", Log.c_str());
+    fputs(Json.c_str(), stdout);
+
+    if(Result == 1 || Result == 2) Pause();
+
+    return Result;
 }
 //------------------------------------------------------------------------------
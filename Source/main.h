@@ -22,44 +22,55 @@
 #define main_h
 //------------------------------------------------------------------------------
 
-#include <math.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-//------------------------------------------------------------------------------
-
-bool  Error = false;
-
-FILE* Input;
-FILE* Output;
-
-char* Line;
+#include <time.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-bool Format_25        = false;
-int  IntDigits        = 3;
-int  FractionDigits   = 3;
-bool LeadingZeros     = true;
-bool RecognisedFormat = false;
-
-int  Tool    = 0;
-int  MaxTool = 0;
-bool ToolSelected = false;
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <sys/resource.h>
+#endif
 
-int pX = 0, pY = 0;
+#ifdef __linux__
+    #include <poll.h>
+    #include <sys/inotify.h>
+#endif
 
-enum MODE{
-    Mode_Drill,
-    Mode_Route_Move,
-    Mode_Route_Linear,
-    Mode_Route_CW,
-    Mode_Route_CCW,
-    Mode_Route_Canned_CW,
-    Mode_Route_Canned_CCW,
-} Mode = Mode_Drill;
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
 
-enum Z_AXIS{
-    Z_Routing,
-    Z_Retracted
-} Z_Axis = Z_Retracted;
+#include "Cache.h"
+#include "Converter.h"
+#include "Csv.h"
+#include "Dedupe.h"
+#include "Dxf.h"
+#include "Fanout.h"
+#include "Incremental.h"
+#include "Merge.h"
+#include "Panel.h"
+#include "Preview.h"
+#include "Reorder.h"
+#include "Server.h"
+#include "Simplify.h"
+#include "Split.h"
+#include "Svg.h"
+#include "ThreadPool.h"
+#include "Unroll.h"
 //------------------------------------------------------------------------------
 
 #endif